@@ -0,0 +1,68 @@
+/*
+ * CombinedOSC, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "ofMain.h"
+#include "ofAppNoWindow.h"
+#include "ofApp.h"
+
+int main(int argc, char *argv[]) {
+
+	// run without a window? set in the settings, overridden by the commandline
+	bool headless = false;
+	ofXml xml;
+	if(xml.load(SETTINGS)) {
+		headless = xml.getChild("settings").getChild("headless").getBoolValue();
+	}
+	for(int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if(arg == "-n" || arg == "--headless") {
+			headless = true;
+		}
+		else if(arg == "-w" || arg == "--window") {
+			headless = false;
+		}
+	}
+
+	ofApp *app = new ofApp();
+	app->bHeadless = headless;
+	for(int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if((arg == "-r" || arg == "--record") && i+1 < argc) {
+			app->recordFile = argv[++i];
+		}
+		else if((arg == "-p" || arg == "--replay") && i+1 < argc) {
+			app->replayFile = argv[++i];
+		}
+		else if(arg == "-f" || arg == "--fast") {
+			app->bReplayFast = true;
+		}
+		else if(arg == "--loop") {
+			app->bReplayLoop = true;
+		}
+	}
+	if(headless) {
+		ofSetupOpenGL(std::make_shared<ofAppNoWindow>(), 640, 480, OF_WINDOW);
+	}
+	else {
+		ofSetupOpenGL(640, 480, OF_WINDOW);
+	}
+	ofRunApp(app);
+}
@@ -0,0 +1,59 @@
+/*
+ * CombinedOSC, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ * Largely adapted from the Kinect Titty Tracker:
+ * http://danomatika.com/projects/kinect-titty-tracker
+ *
+ */
+#include "ofApp.h"
+
+//--------------------------------------------------------------
+ofApp::ofApp() {
+	estimators.push_back(&head); // primary
+	estimators.push_back(&overhead);
+}
+
+//--------------------------------------------------------------
+void ofApp::resetEstimatorSettings() {
+	head.highestPointThreshold = 50;
+	head.headInterpolation = 0.6;
+}
+
+//--------------------------------------------------------------
+void ofApp::loadEstimatorSettings(ofXml &tracking) {
+	head.highestPointThreshold = tracking.getChild("highestPointThreshold").getUintValue();
+	head.headInterpolation = tracking.getChild("headInterpolation").getFloatValue();
+}
+
+//--------------------------------------------------------------
+void ofApp::saveEstimatorSettings(ofXml &tracking) {
+	tracking.appendChild("highestPointThreshold").set(head.highestPointThreshold);
+	tracking.appendChild("headInterpolation").set(head.headInterpolation);
+}
+
+//--------------------------------------------------------------
+void ofApp::drawEstimate(const TrackerCore::Person &person) {
+
+	// gold - highest point
+	Position highestPoint = HeadEstimator::highestPoint(person.blob);
+	ofFill();
+	ofSetColor(255, 255, 0);
+	ofDrawRectangle(highestPoint.x, highestPoint.y, 10, 10);
+}
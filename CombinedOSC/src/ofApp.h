@@ -0,0 +1,46 @@
+/*
+ * CombinedOSC, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ * Largely adapted from the Kinect Titty Tracker:
+ * http://danomatika.com/projects/kinect-titty-tracker
+ *
+ */
+#pragma once
+
+#include "TrackerApp.h"
+#include "HeadEstimator.h"
+#include "OverheadEstimator.h"
+
+// head & overhead trackers sharing one kinect: both estimators run on the
+// same blobs, so the overhead only costs its own estimate
+class ofApp : public TrackerApp {
+
+	public:
+		ofApp();
+
+	protected:
+		void resetEstimatorSettings();
+		void loadEstimatorSettings(ofXml &tracking);
+		void saveEstimatorSettings(ofXml &tracking);
+		void drawEstimate(const TrackerCore::Person &person);
+
+		HeadEstimator head;         // head between the person centroid & highest point
+		OverheadEstimator overhead; // nearest point in the person blob
+};
@@ -20,9 +20,49 @@
  *
  */
 #include "ofMain.h"
+#include "ofAppNoWindow.h"
 #include "ofApp.h"
 
-int main() {
-	ofSetupOpenGL(640, 480, OF_WINDOW);
-	ofRunApp(new ofApp());
+int main(int argc, char *argv[]) {
+
+	// run without a window? set in the settings, overridden by the commandline
+	bool headless = false;
+	ofXml xml;
+	if(xml.load(SETTINGS)) {
+		headless = xml.getChild("settings").getChild("headless").getBoolValue();
+	}
+	for(int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if(arg == "-n" || arg == "--headless") {
+			headless = true;
+		}
+		else if(arg == "-w" || arg == "--window") {
+			headless = false;
+		}
+	}
+
+	ofApp *app = new ofApp();
+	app->bHeadless = headless;
+	for(int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if((arg == "-r" || arg == "--record") && i+1 < argc) {
+			app->recordFile = argv[++i];
+		}
+		else if((arg == "-p" || arg == "--replay") && i+1 < argc) {
+			app->replayFile = argv[++i];
+		}
+		else if(arg == "-f" || arg == "--fast") {
+			app->bReplayFast = true;
+		}
+		else if(arg == "--loop") {
+			app->bReplayLoop = true;
+		}
+	}
+	if(headless) {
+		ofSetupOpenGL(std::make_shared<ofAppNoWindow>(), 640, 480, OF_WINDOW);
+	}
+	else {
+		ofSetupOpenGL(640, 480, OF_WINDOW);
+	}
+	ofRunApp(app);
 }
@@ -24,71 +24,17 @@
  */
 #pragma once
 
-#include "ofMain.h"
+#include "TrackerApp.h"
+#include "OverheadEstimator.h"
 
-#include "ofxOpenCv.h"
-#include "ofxKinect.h"
-#include "ofxOsc.h"
-
-#define SETTINGS "settings.xml"
-
-class ofApp : public ofBaseApp {
+// overhead tracker
+class ofApp : public TrackerApp {
 
 	public:
-		void setup();
-		void update();
-		void draw();
-		void exit();
-		void keyPressed(int key);
-		
-		void resetSettings();
-		bool loadSettings(const std::string xmlFile=SETTINGS);
-		bool saveSettings(const std::string xmlFile=SETTINGS);
-		
-		// find the nearest (aka brightest) point in a given area of depth pixels
-		// from Kinect Titty Tracker
-		ofPoint findNearestPoint(ofPixels& pixels, ofRectangle searchBox, int maxValue=256);
-
-		ofxKinect kinect;    // our RGB/depth camera of course
-		ofxOscSender sender; // for sending head position
+		ofApp();
 
-		// search images
-		ofxCvGrayscaleImage depthImage; // grayscale depth image
-		ofxCvGrayscaleImage depthDiff;  // thresholded person finder image
+	protected:
+		void resetEstimatorSettings();
 
-		// blob trackers
-		ofxCvContourFinder 	personFinder;
-		
-		// positions
-		ofRectangle person;  // found person centroid & size
-		ofPoint overhead;    // found overhead position
-		ofPoint overheadAdj; // adjust overhead position after normalize & scale
-		
-		// settings
-		int threshold;	// person finder depth clipping threshold (0-255)
-		unsigned int nearClipping, farClipping; // kinect clipping planes in cm
-		unsigned int personMinArea, personMaxArea; // min and max area for the person finder
-		
-		// normalize the head coordinates?
-		bool bNormalizeX; // 0-kinect.width
-		bool bNormalizeY; // 0-kinect.height
-		bool bNormalizeZ; // nearClipping-farClipping
-		
-		// scale head coordinates?
-		bool bScaleX, bScaleY, bScaleZ;
-		float scaleXAmt, scaleYAmt, scaleZAmt; // how much to scale
-		
-		// live image to display
-		enum DisplayImage {
-			NONE = 0,
-			THRESHOLD = 1,
-			RGB = 2,
-			DEPTH = 3
-		} displayImage;
-		
-		// osc send destination
-		std::string sendAddress;
-		unsigned int sendPort;
-		
-		unsigned int kinectID; // which kinect to use
+		OverheadEstimator overhead; // nearest point in the person blob
 };
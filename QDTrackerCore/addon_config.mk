@@ -0,0 +1,20 @@
+# QDTrackerCore local addon, see the OF addon_config.mk docs for details
+
+meta:
+	ADDON_NAME = QDTrackerCore
+	ADDON_DESCRIPTION = Quick N Dirty Tracker shared kinect tracking core
+	ADDON_AUTHOR = Dan Wilcox
+	ADDON_TAGS = "kinect" "tracking" "osc"
+	ADDON_URL = https://github.com/danomatika/QDTracker
+
+common:
+	ADDON_DEPENDENCIES = ofxKinect
+	# only src is part of the addon, tools are built with CMake
+	ADDON_SOURCES_EXCLUDE = tools/%
+
+linux64:
+	# shm_open is in librt before glibc 2.34
+	ADDON_LDFLAGS = -lrt
+
+linux:
+	ADDON_LDFLAGS = -lrt
@@ -0,0 +1,142 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "BackgroundModel.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+
+#include "DepthKernels.h"
+
+struct BackgroundModelHeader {
+	char magic[4];         // BACKGROUNDMODEL_MAGIC
+	std::uint32_t version; // BACKGROUNDMODEL_VERSION
+	std::uint32_t width;   // background width
+	std::uint32_t height;  // background height
+};
+
+//--------------------------------------------------------------
+void BackgroundModel::setup(std::size_t width, std::size_t height) {
+	this->width = width;
+	this->height = height;
+	background.assign(width * height, 0);
+	learnFrames = 0;
+}
+
+//--------------------------------------------------------------
+void BackgroundModel::reset(unsigned int learnFrames) {
+	std::fill(background.begin(), background.end(), 0);
+	this->learnFrames = learnFrames;
+	steps = 0;
+}
+
+//--------------------------------------------------------------
+void BackgroundModel::update(const std::uint16_t *depth, std::size_t depthStride, float rate,
+                             ThreadPool *pool) {
+	if(learnFrames > 0) {
+		rate = std::max(rate, (float)LEARN_RATE);
+		learnFrames--;
+	}
+
+	// whole mm steps, skipping frames until a sub-mm rate adds up to one
+	if(rate > 0) {
+		steps += std::min(rate, 65535.0f);
+		if(steps < 1) {
+			return;
+		}
+	}
+	std::uint16_t step = (std::uint16_t)steps;
+	steps -= step;
+	if(!pool || pool->getNumThreads() < 2) {
+		if(depthStride == width) {
+			updateBackground(depth, background.data(), background.size(), step);
+			return;
+		}
+		for(std::size_t y = 0; y < height; ++y) {
+			updateBackground(depth + y * depthStride, background.data() + y * width, width, step);
+		}
+		return;
+	}
+
+	// a band of rows per task
+	std::size_t numBands = pool->getNumThreads();
+	auto band = [&](std::size_t b) {
+		for(std::size_t y = height * b / numBands; y < height * (b + 1) / numBands; ++y) {
+			updateBackground(depth + y * depthStride, background.data() + y * width, width, step);
+		}
+	};
+	pool->run(numBands, band);
+}
+
+//--------------------------------------------------------------
+bool BackgroundModel::load(const std::string &path) {
+	errno = 0;
+	std::FILE *file = std::fopen(path.c_str(), "rb");
+	if(!file) {
+		error = "couldn't open " + path + ": " + std::strerror(errno);
+		return false;
+	}
+	BackgroundModelHeader header;
+	bool ok = (std::fread(&header, sizeof(header), 1, file) == 1 &&
+	           std::memcmp(header.magic, BACKGROUNDMODEL_MAGIC, 4) == 0 &&
+	           header.version == BACKGROUNDMODEL_VERSION);
+	if(!ok) {
+		error = path + " is not a background model";
+	}
+	else if(header.width != width || header.height != height) {
+		error = path + " has a different frame size";
+		ok = false;
+	}
+	else if(std::fread(background.data(), sizeof(std::uint16_t), background.size(), file) != background.size()) {
+		error = path + " is truncated";
+		std::fill(background.begin(), background.end(), 0);
+		ok = false;
+	}
+	std::fclose(file);
+	if(ok) {
+		learnFrames = 0;
+	}
+	return ok;
+}
+
+//--------------------------------------------------------------
+bool BackgroundModel::save(const std::string &path) {
+	errno = 0;
+	std::FILE *file = std::fopen(path.c_str(), "wb");
+	if(!file) {
+		error = "couldn't open " + path + ": " + std::strerror(errno);
+		return false;
+	}
+	BackgroundModelHeader header;
+	std::memcpy(header.magic, BACKGROUNDMODEL_MAGIC, 4);
+	header.version = BACKGROUNDMODEL_VERSION;
+	header.width = width;
+	header.height = height;
+	bool ok = (std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+	           std::fwrite(background.data(), sizeof(std::uint16_t), background.size(), file) == background.size());
+	if(std::fclose(file) != 0 || !ok) {
+		error = "couldn't write " + path + ": " + std::strerror(errno);
+		return false;
+	}
+	return true;
+}
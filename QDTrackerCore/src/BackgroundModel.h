@@ -0,0 +1,90 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "ThreadPool.h"
+
+#define BACKGROUNDMODEL_MAGIC "QDBG"
+#define BACKGROUNDMODEL_VERSION 1
+
+// learned per-pixel background depth in mm for a static scene, ie. furniture
+//
+// each pixel is an approximate running median of the raw depth, moving at
+// most the adapt rate per frame: fast enough to learn things that were moved
+// over a few minutes but too slow to learn persons walking by or standing
+// still, adapting quickly for a number of frames after a reset to learn a new
+// scene
+//
+// rates below 1 mm per frame are accumulated & applied as whole mm steps,
+// skipping the frames in between: ie. 0.1 steps 1 mm every 10th frame, so a
+// person standing 1 m in front of the background at 30 fps is absorbed after
+// 1000 mm / 0.1 mm / 30 fps ~ 5.5 minutes
+//
+// saved as a small binary file (.qdb): a 16 byte header followed by the raw
+// 16 bit background depth
+class BackgroundModel {
+
+	public:
+
+		// allocate for the frame size, the background is unknown until learned
+		void setup(std::size_t width, std::size_t height);
+
+		// forget the background & learn it again quickly for learnFrames
+		void reset(unsigned int learnFrames);
+
+		// adapt to a raw depth frame by at most rate mm per pixel, depthStride
+		// is in pixels, split into bands of rows with an optional thread pool:
+		// a 0 rate only learns unknown pixels
+		void update(const std::uint16_t *depth, std::size_t depthStride, float rate,
+		            ThreadPool *pool=nullptr);
+
+		// learning quickly after a reset?
+		bool isLearning() const {return learnFrames > 0;}
+
+		// background depth in mm, 0 where unknown, stride is the width
+		const std::uint16_t* getData() const {return background.data();}
+
+		std::size_t getWidth() const {return width;}
+		std::size_t getHeight() const {return height;}
+
+		// load & save the background, returns false on error ie. when the
+		// frame size doesn't match the setup() size
+		bool load(const std::string &path);
+		bool save(const std::string &path);
+
+		const std::string& getError() const {return error;}
+
+		static const unsigned int LEARN_RATE = 64; // mm per frame while learning
+
+	private:
+
+		std::size_t width = 0, height = 0;
+		std::vector<std::uint16_t> background;
+		unsigned int learnFrames = 0; // frames left to learn quickly
+		float steps = 0; // accumulated sub-mm rate, applied once it reaches 1 mm
+		std::string error;
+};
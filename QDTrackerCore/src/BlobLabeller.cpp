@@ -0,0 +1,322 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "BlobLabeller.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+#include "DepthKernels.h"
+
+// skip runs of 0 or non-0 bytes a word at a time, masks are mostly empty
+//--------------------------------------------------------------
+static inline std::size_t skipClear(const std::uint8_t *row, std::size_t x, std::size_t width) {
+	while(x + 8 <= width) {
+		std::uint64_t word;
+		std::memcpy(&word, row + x, 8);
+		if(word != 0) {
+			break;
+		}
+		x += 8;
+	}
+	while(x < width && row[x] == 0) {
+		x++;
+	}
+	return x;
+}
+
+//--------------------------------------------------------------
+static inline std::size_t skipSet(const std::uint8_t *row, std::size_t x, std::size_t width) {
+	// threshold masks are 0 or 255, so a full word of 255 is all set
+	while(x + 8 <= width) {
+		std::uint64_t word;
+		std::memcpy(&word, row + x, 8);
+		if(word != UINT64_MAX) {
+			break;
+		}
+		x += 8;
+	}
+	while(x < width && row[x] != 0) {
+		x++;
+	}
+	return x;
+}
+
+//--------------------------------------------------------------
+void BlobLabeller::setup(std::size_t width, std::size_t height, std::size_t maxBlobs) {
+	this->width = width;
+	this->height = height;
+	std::size_t maxRuns = ((width + 1) / 2) * height; // checkerboard worst case
+	runs.resize(maxRuns);
+	parents.resize(maxRuns);
+	components.resize(maxRuns);
+	roots.reserve(maxRuns);
+	blobs.resize(maxBlobs);
+	blobRoots.resize(maxBlobs);
+	bands.resize(std::max(height / MIN_BAND_ROWS, (std::size_t)1));
+	numBands = 0;
+	numBlobs = 0;
+}
+
+//--------------------------------------------------------------
+std::size_t BlobLabeller::label(const std::uint8_t *mask, std::size_t maskStride,
+                                const std::uint16_t *depth, std::size_t depthStride,
+                                unsigned int minArea, unsigned int maxArea,
+                                std::size_t maxBlobs, int topBand, ThreadPool *pool) {
+	Region region;
+	region.width = width;
+	region.height = height;
+	return label(mask, maskStride, depth, depthStride, region,
+	             minArea, maxArea, maxBlobs, topBand, pool);
+}
+
+//--------------------------------------------------------------
+std::size_t BlobLabeller::label(const std::uint8_t *mask, std::size_t maskStride,
+                                const std::uint16_t *depth, std::size_t depthStride,
+                                const Region &region,
+                                unsigned int minArea, unsigned int maxArea,
+                                std::size_t maxBlobs, int topBand, ThreadPool *pool) {
+	numBlobs = 0;
+	roots.clear();
+	maxBlobs = std::min(maxBlobs, blobs.size());
+
+	// clip region to the image
+	std::size_t x0 = std::min((std::size_t)std::max(region.x, 0), width);
+	std::size_t y0 = std::min((std::size_t)std::max(region.y, 0), height);
+	std::size_t x1 = std::min((std::size_t)std::max(region.x + region.width, 0), width);
+	std::size_t y1 = std::min((std::size_t)std::max(region.y + region.height, 0), height);
+
+	// split the rows into bands, each with room for the most runs its rows
+	// can hold so their runs stay in raster order
+	std::size_t rows = y1 - y0, rowRuns = (x1 - x0 + 1) / 2;
+	numBands = 1;
+	if(pool && pool->getNumThreads() > 1) {
+		numBands = std::min(pool->getNumThreads() * BANDS_PER_THREAD, rows / MIN_BAND_ROWS);
+		numBands = std::max(std::min(numBands, bands.size()), (std::size_t)1);
+	}
+	for(std::size_t b = 0; b < numBands; ++b) {
+		Band &band = bands[b];
+		band.y0 = y0 + rows * b / numBands;
+		band.y1 = y0 + rows * (b + 1) / numBands;
+		band.runStart = (band.y0 - y0) * rowRuns;
+	}
+
+	// collect runs & join them to touching runs on the previous row, each
+	// band on its own: the union-find only ever links runs within a band
+	auto collect = [&](std::size_t b) {
+		collectBand(bands[b], mask, maskStride, depth, depthStride, x0, x1);
+	};
+	if(numBands > 1) {
+		pool->run(numBands, collect);
+	}
+	else {
+		collect(0);
+	}
+
+	// merge blobs crossing band edges: the last row of each band with the
+	// first of the next
+	for(std::size_t b = 1; b < numBands; ++b) {
+		joinRows(bands[b-1].lastRowStart, bands[b-1].runEnd, bands[b].runStart, bands[b].firstRowEnd);
+	}
+
+	// accumulate component stats per root run
+	for(std::size_t b = 0; b < numBands; ++b) {
+		for(std::uint32_t r = bands[b].runStart; r < bands[b].runEnd; ++r) {
+			const Run &run = runs[r];
+			std::uint32_t root = find(r);
+			Component &c = components[root];
+			if(root == r) { // runs are visited in order, so the root comes first
+				c.area = c.sumX = c.sumY = 0;
+				c.minX = run.x0;
+				c.minY = run.y;
+				c.maxX = run.x1 - 1;
+				c.maxY = run.y;
+				c.nearestDepth = 0;
+				c.nearestX = c.nearestY = -1;
+				c.blob = -1;
+				roots.push_back(r);
+			}
+			std::uint64_t length = run.x1 - run.x0;
+			c.area += length;
+			c.sumX += (std::uint64_t)(run.x0 + run.x1 - 1) * length / 2;
+			c.sumY += (std::uint64_t)run.y * length;
+			c.minX = std::min(c.minX, (int)run.x0);
+			c.maxX = std::max(c.maxX, (int)run.x1 - 1);
+			c.maxY = run.y;
+			if(run.nearestDepth != 0 && (c.nearestDepth == 0 || run.nearestDepth < c.nearestDepth)) {
+				c.nearestDepth = run.nearestDepth;
+				c.nearestX = run.nearestX;
+				c.nearestY = run.y;
+			}
+		}
+	}
+
+	// keep the largest components within the area range
+	for(std::size_t i = 0; i < roots.size(); ++i) {
+		const Component &c = components[roots[i]];
+		if(c.area < minArea || c.area > maxArea) {
+			continue;
+		}
+		// insertion into the small sorted blob list
+		std::size_t slot = numBlobs;
+		while(slot > 0 && c.area > blobs[slot-1].area) {
+			slot--;
+		}
+		if(slot >= maxBlobs) {
+			continue;
+		}
+		std::size_t last = std::min(numBlobs, maxBlobs-1);
+		for(std::size_t j = last; j > slot; --j) {
+			blobs[j] = blobs[j-1];
+			blobRoots[j] = blobRoots[j-1];
+		}
+		Blob &b = blobs[slot];
+		b.area = c.area;
+		b.centroidX = (float)c.sumX / c.area;
+		b.centroidY = (float)c.sumY / c.area;
+		b.x = c.minX;
+		b.y = c.minY;
+		b.width = c.maxX - c.minX + 1;
+		b.height = c.maxY - c.minY + 1;
+		b.topX = b.topY = -1;
+		b.nearestX = c.nearestX;
+		b.nearestY = c.nearestY;
+		b.nearestDepth = c.nearestDepth;
+		blobRoots[slot] = roots[i];
+		if(numBlobs < maxBlobs) {
+			numBlobs++;
+		}
+	}
+	for(std::size_t i = 0; i < numBlobs; ++i) {
+		components[blobRoots[i]].blob = i;
+	}
+
+	// topmost pixel within the band around each blob's centroid, runs are in
+	// raster order so the first overlapping run of a blob is the top
+	std::size_t remaining = numBlobs;
+	for(std::size_t b = 0; b < numBands && remaining > 0; ++b) {
+		for(std::uint32_t r = bands[b].runStart; r < bands[b].runEnd && remaining > 0; ++r) {
+			const Run &run = runs[r];
+			int i = components[find(r)].blob;
+			if(i < 0 || blobs[i].topY >= 0) {
+				continue;
+			}
+			Blob &blob = blobs[i];
+			// open interval (centroid - band, centroid + band)
+			int lo = std::max((int)run.x0, (int)std::floor(blob.centroidX - topBand) + 1);
+			int hi = std::min((int)run.x1 - 1, (int)std::ceil(blob.centroidX + topBand) - 1);
+			if(lo <= hi) {
+				blob.topX = (lo + hi) / 2;
+				blob.topY = run.y;
+				remaining--;
+			}
+		}
+	}
+
+	return numBlobs;
+}
+
+//--------------------------------------------------------------
+void BlobLabeller::collectBand(Band &band, const std::uint8_t *mask, std::size_t maskStride,
+                               const std::uint16_t *depth, std::size_t depthStride,
+                               std::size_t x0, std::size_t x1) {
+	std::uint32_t numRuns = band.runStart;
+	std::uint32_t prevStart = numRuns, prevEnd = numRuns; // previous row's runs
+	band.firstRowEnd = band.lastRowStart = numRuns;
+	for(std::size_t y = band.y0; y < band.y1; ++y) {
+		const std::uint8_t *row = mask + y * maskStride;
+		const std::uint16_t *depthRow = depth ? depth + y * depthStride : nullptr;
+		std::uint32_t rowStart = numRuns;
+		std::size_t x = skipClear(row, x0, x1);
+		while(x < x1) {
+			std::size_t end = skipSet(row, x, x1);
+			std::uint32_t r = numRuns++;
+			Run &run = runs[r];
+			run.y = y;
+			run.x0 = x;
+			run.x1 = end;
+			run.nearestDepth = 0;
+			run.nearestX = x;
+			if(depthRow) {
+				int i = findNearest(depthRow + x, end - x);
+				if(i >= 0) {
+					run.nearestX = x + i;
+					run.nearestDepth = depthRow[run.nearestX];
+				}
+			}
+			parents[r] = r;
+			x = skipClear(row, end, x1);
+		}
+		joinRows(prevStart, prevEnd, rowStart, numRuns);
+		if(y == band.y0) {
+			band.firstRowEnd = numRuns;
+		}
+		prevStart = rowStart;
+		prevEnd = numRuns;
+	}
+	band.lastRowStart = prevStart;
+	band.runEnd = numRuns;
+}
+
+//--------------------------------------------------------------
+void BlobLabeller::joinRows(std::uint32_t prevStart, std::uint32_t prevEnd,
+                            std::uint32_t rowStart, std::uint32_t rowEnd) {
+	// 8-connected: previous runs touching [x0-1, x1]
+	std::uint32_t p = prevStart;
+	for(std::uint32_t r = rowStart; r < rowEnd; ++r) {
+		const Run &run = runs[r];
+		while(p < prevEnd && runs[p].x1 < run.x0) {
+			p++;
+		}
+		for(std::uint32_t q = p; q < prevEnd && runs[q].x0 <= run.x1; ++q) {
+			join(r, q);
+		}
+		if(p < prevEnd && runs[p].x1 <= run.x1) {
+			p++; // can't touch the next run on this row
+		}
+	}
+}
+
+//--------------------------------------------------------------
+std::uint32_t BlobLabeller::find(std::uint32_t run) {
+	while(parents[run] != run) {
+		parents[run] = parents[parents[run]]; // path halving
+		run = parents[run];
+	}
+	return run;
+}
+
+//--------------------------------------------------------------
+void BlobLabeller::join(std::uint32_t a, std::uint32_t b) {
+	a = find(a);
+	b = find(b);
+	if(a == b) {
+		return;
+	}
+	// the earlier run becomes the root so roots are met first in order
+	if(a < b) {
+		parents[b] = a;
+	}
+	else {
+		parents[a] = b;
+	}
+}
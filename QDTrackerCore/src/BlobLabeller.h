@@ -0,0 +1,140 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "ThreadPool.h"
+
+// a connected blob of mask pixels
+struct Blob {
+	unsigned int area = 0;         // pixel count
+	float centroidX = 0, centroidY = 0;
+	int x = 0, y = 0;              // bounding box top left
+	int width = 0, height = 0;     // bounding box size
+	int topX = -1, topY = -1;      // topmost pixel within the top band, -1 if none
+	int nearestX = -1, nearestY = -1; // nearest known depth pixel, -1 if none
+	std::uint16_t nearestDepth = 0;   // nearest depth in mm, 0 if none
+};
+
+// rectangular image region
+struct Region {
+	int x = 0, y = 0;          // top left
+	int width = 0, height = 0; // size
+};
+
+// single pass run-length connected components labeller (8-connected)
+//
+// scans the mask once, collecting horizontal runs & joining them to touching
+// runs on the previous row with union-find, then computes blob stats from the
+// runs only: much less work than tracing contours & rescanning their points
+//
+// with a thread pool, the rows are split into bands which collect & join their
+// runs in parallel, then the runs touching across band edges are joined
+//
+// all storage is sized by setup(), so label() never allocates
+class BlobLabeller {
+
+	public:
+
+		// allocate for the given image size & max number of blobs to return
+		void setup(std::size_t width, std::size_t height, std::size_t maxBlobs=10);
+
+		// find blobs in a binary mask (non-zero is set), largest first
+		//
+		// depth: optional raw depth in mm for the nearest pixel, same size as
+		// mask with the stride in pixels
+		// minArea, maxArea: blob pixel area range to keep
+		// maxBlobs: max number of blobs to keep, up to the setup() max
+		// topBand: the top pixel is searched within centroid x +- topBand
+		// pool: optional thread pool to collect runs in parallel bands
+		//
+		// returns the number of blobs found
+		std::size_t label(const std::uint8_t *mask, std::size_t maskStride,
+		                  const std::uint16_t *depth, std::size_t depthStride,
+		                  unsigned int minArea, unsigned int maxArea,
+		                  std::size_t maxBlobs, int topBand, ThreadPool *pool=nullptr);
+
+		// find blobs only within a region of the mask, blob positions are still
+		// in full image coordinates & blobs are clipped to the region
+		std::size_t label(const std::uint8_t *mask, std::size_t maskStride,
+		                  const std::uint16_t *depth, std::size_t depthStride,
+		                  const Region &region,
+		                  unsigned int minArea, unsigned int maxArea,
+		                  std::size_t maxBlobs, int topBand, ThreadPool *pool=nullptr);
+
+		std::size_t size() const {return numBlobs;}
+		const Blob& getBlob(std::size_t i) const {return blobs[i];}
+		const Blob& operator[](std::size_t i) const {return blobs[i];}
+
+	private:
+
+		// horizontal run of set pixels: [x0, x1) on row y
+		struct Run {
+			std::uint16_t y, x0, x1;
+			std::uint16_t nearestDepth; // nearest depth within the run, 0 if none
+			std::uint16_t nearestX;
+		};
+
+		// per-component accumulators, indexed by root run
+		struct Component {
+			std::uint64_t area, sumX, sumY;
+			int minX, minY, maxX, maxY;
+			std::uint16_t nearestDepth;
+			int nearestX, nearestY;
+			int blob; // index into blobs if kept, otherwise -1
+		};
+
+		// rows [y0, y1) & their runs: [runStart, runEnd)
+		struct Band {
+			std::size_t y0, y1;
+			std::uint32_t runStart, runEnd;
+			std::uint32_t firstRowEnd, lastRowStart; // runs on the first & last rows
+		};
+
+		static const std::size_t BANDS_PER_THREAD = 4; // for stealing
+		static const std::size_t MIN_BAND_ROWS = 8;
+
+		// collect a band's runs & join them within the band
+		void collectBand(Band &band, const std::uint8_t *mask, std::size_t maskStride,
+		                 const std::uint16_t *depth, std::size_t depthStride,
+		                 std::size_t x0, std::size_t x1);
+
+		// join the runs on a row to touching runs on the previous row
+		void joinRows(std::uint32_t prevStart, std::uint32_t prevEnd,
+		              std::uint32_t rowStart, std::uint32_t rowEnd);
+
+		std::uint32_t find(std::uint32_t run);
+		void join(std::uint32_t a, std::uint32_t b);
+
+		std::size_t width = 0, height = 0;
+		std::vector<Run> runs;
+		std::vector<std::uint32_t> parents;   // union-find parent per run
+		std::vector<Component> components;   // valid for root runs only
+		std::vector<std::uint32_t> roots;     // root runs, in order found
+		std::vector<Blob> blobs;
+		std::vector<std::uint32_t> blobRoots; // root run for each blob
+		std::vector<Band> bands;
+		std::size_t numBands = 0, numBlobs = 0;
+};
@@ -0,0 +1,181 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "DepthFilter.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "DepthKernels.h"
+
+// run a pass's bands of rows on the pool or all of them on this thread
+template<typename Band>
+static void runBands(ThreadPool *pool, std::size_t numBands, Band &band) {
+	if(pool) {
+		pool->run(numBands, band);
+	}
+	else {
+		band(0);
+	}
+}
+
+//--------------------------------------------------------------
+void DepthFilter::setup(std::size_t width, std::size_t height) {
+	this->width = width;
+	this->height = height;
+	buffers[0].assign(width * height, 0);
+	buffers[1].assign(width * height, 0);
+	smoothed.assign(width * height, 0);
+	bSmoothed = false;
+}
+
+//--------------------------------------------------------------
+const std::uint16_t* DepthFilter::filter(const std::uint16_t *depth, std::size_t depthStride,
+                                         const Settings &settings, ThreadPool *pool) {
+	unsigned int medianSize = (settings.medianSize >= 5 ? 5 : (settings.medianSize >= 3 ? 3 : 0));
+	if(settings.smoothing <= 0) {
+		bSmoothed = false;
+	}
+	if(!settings.isEnabled() || width < 5 || height < 5) {
+		return depth;
+	}
+
+	// each pass reads the last one's output, so a pass runs across the pool in
+	// bands of rows & the next starts once it's done
+	std::size_t numBands = (pool ? pool->getNumThreads() : 1);
+	const std::uint16_t *src = depth;
+	std::size_t srcStride = depthStride;
+	std::uint16_t *dst = buffers[0].data();
+	auto next = [&]() {
+		src = dst;
+		srcStride = width;
+		dst = (dst == buffers[0].data() ? buffers[1].data() : buffers[0].data());
+	};
+	if(settings.bFillHoles) {
+		auto rows = [&](std::size_t b) {
+			fillRows(src, srcStride, dst, height * b / numBands, height * (b + 1) / numBands);
+		};
+		runBands(pool, numBands, rows);
+		next();
+		auto columns = [&](std::size_t b) {
+			fillColumns(src, dst, height * b / numBands, height * (b + 1) / numBands);
+		};
+		runBands(pool, numBands, columns);
+		next();
+	}
+	if(medianSize > 0) {
+		auto rows = [&](std::size_t b) {
+			medianRows(src, srcStride, dst, medianSize, height * b / numBands, height * (b + 1) / numBands);
+		};
+		runBands(pool, numBands, rows);
+		next();
+		auto columns = [&](std::size_t b) {
+			medianColumns(src, dst, medianSize, height * b / numBands, height * (b + 1) / numBands);
+		};
+		runBands(pool, numBands, columns);
+		next();
+	}
+	if(settings.smoothing <= 0) {
+		return src;
+	}
+
+	// smooth into the last frame's depth, starting again with this frame
+	unsigned int weight = 256 - (unsigned int)(std::min(settings.smoothing, 1.0f) * 256 + 0.5f);
+	std::uint16_t jump = (std::uint16_t)std::min(settings.smoothingJump, 0x7FFFu);
+	auto smooth = [&](std::size_t b) {
+		for(std::size_t y = height * b / numBands; y < height * (b + 1) / numBands; ++y) {
+			if(bSmoothed) {
+				smoothDepth(src + y * srcStride, smoothed.data() + y * width, width, weight, jump);
+			}
+			else {
+				std::memcpy(smoothed.data() + y * width, src + y * srcStride, width * sizeof(std::uint16_t));
+			}
+		}
+	};
+	runBands(pool, numBands, smooth);
+	bSmoothed = true;
+	return smoothed.data();
+}
+
+//--------------------------------------------------------------
+void DepthFilter::fillRows(const std::uint16_t *src, std::size_t srcStride, std::uint16_t *dst,
+                           std::size_t y0, std::size_t y1) const {
+	for(std::size_t y = y0; y < y1; ++y) {
+		const std::uint16_t *row = src + y * srcStride;
+		std::uint16_t *out = dst + y * width;
+		fillDepthHoles(row, row + 1, row + 2, out + 1, width - 2);
+		out[0] = row[0];
+		out[width - 1] = row[width - 1];
+	}
+}
+
+//--------------------------------------------------------------
+void DepthFilter::fillColumns(const std::uint16_t *src, std::uint16_t *dst,
+                              std::size_t y0, std::size_t y1) const {
+	for(std::size_t y = y0; y < y1; ++y) {
+		const std::uint16_t *row = src + y * width;
+		if(y < 1 || y + 1 >= height) {
+			std::memcpy(dst + y * width, row, width * sizeof(std::uint16_t));
+			continue;
+		}
+		fillDepthHoles(row - width, row, row + width, dst + y * width, width);
+	}
+}
+
+//--------------------------------------------------------------
+void DepthFilter::medianRows(const std::uint16_t *src, std::size_t srcStride, std::uint16_t *dst,
+                             unsigned int size, std::size_t y0, std::size_t y1) const {
+	std::size_t r = size / 2;
+	for(std::size_t y = y0; y < y1; ++y) {
+		const std::uint16_t *row = src + y * srcStride;
+		std::uint16_t *out = dst + y * width;
+		if(size == 5) {
+			medianDepth5(row, row + 1, row + 2, row + 3, row + 4, out + 2, width - 4);
+		}
+		else {
+			medianDepth3(row, row + 1, row + 2, out + 1, width - 2);
+		}
+		for(std::size_t x = 0; x < r; ++x) {
+			out[x] = row[x];
+			out[width - 1 - x] = row[width - 1 - x];
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void DepthFilter::medianColumns(const std::uint16_t *src, std::uint16_t *dst, unsigned int size,
+                                std::size_t y0, std::size_t y1) const {
+	std::size_t r = size / 2;
+	for(std::size_t y = y0; y < y1; ++y) {
+		const std::uint16_t *row = src + y * width;
+		if(y < r || y + r >= height) {
+			std::memcpy(dst + y * width, row, width * sizeof(std::uint16_t));
+			continue;
+		}
+		if(size == 5) {
+			medianDepth5(row - 2 * width, row - width, row, row + width, row + 2 * width,
+			             dst + y * width, width);
+		}
+		else {
+			medianDepth3(row - width, row, row + width, dst + y * width, width);
+		}
+	}
+}
@@ -0,0 +1,88 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "ThreadPool.h"
+
+// optional raw depth denoising before thresholding: spatial hole filling, a
+// separable median, & temporal smoothing, each a row or column pass of a
+// vectorized kernel, see DepthKernels
+//
+// passes ping-pong between two buffers allocated in setup() & the smoothed
+// depth is kept for the next frame, so filtering never allocates
+class DepthFilter {
+
+	public:
+
+		struct Settings {
+			bool bFillHoles = false;         // fill unknown depth from the farther neighbour?
+			unsigned int medianSize = 0;     // median size: 0 off, 3 for 3x3, or 5 for 5x5
+			float smoothing = 0;             // temporal smoothing 0-1: how much of the last frame to keep, 0 off
+			unsigned int smoothingJump = 100; // depth changes bigger than this in mm aren't smoothed
+
+			// any filter enabled?
+			bool isEnabled() const {return bFillHoles || medianSize >= 3 || smoothing > 0;}
+
+			bool operator!=(const Settings &other) const {
+				return bFillHoles != other.bFillHoles || medianSize != other.medianSize ||
+				       smoothing != other.smoothing || smoothingJump != other.smoothingJump;
+			}
+		};
+
+		// allocate for the frame size
+		void setup(std::size_t width, std::size_t height);
+
+		// forget the smoothed depth, the next frame starts it again
+		void reset() {bSmoothed = false;}
+
+		// filter a raw depth frame, depthStride is in pixels, split into bands
+		// of rows with an optional thread pool
+		//
+		// returns the filtered depth, the stride is the width, or the depth
+		// itself if nothing is enabled
+		const std::uint16_t* filter(const std::uint16_t *depth, std::size_t depthStride,
+		                            const Settings &settings, ThreadPool *pool=nullptr);
+
+		std::size_t getWidth() const {return width;}
+		std::size_t getHeight() const {return height;}
+
+	private:
+
+		// filter rows [y0, y1) of src into dst: fill holes or median across
+		// each row or down each column, edges are copied
+		void fillRows(const std::uint16_t *src, std::size_t srcStride, std::uint16_t *dst,
+		              std::size_t y0, std::size_t y1) const;
+		void fillColumns(const std::uint16_t *src, std::uint16_t *dst, std::size_t y0, std::size_t y1) const;
+		void medianRows(const std::uint16_t *src, std::size_t srcStride, std::uint16_t *dst,
+		                unsigned int size, std::size_t y0, std::size_t y1) const;
+		void medianColumns(const std::uint16_t *src, std::uint16_t *dst, unsigned int size,
+		                   std::size_t y0, std::size_t y1) const;
+
+		std::size_t width = 0, height = 0;
+		std::vector<std::uint16_t> buffers[2]; // ping-pong between passes
+		std::vector<std::uint16_t> smoothed;   // last smoothed depth
+		bool bSmoothed = false;                // smoothed depth is current?
+};
@@ -0,0 +1,676 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "DepthKernels.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define DEPTHKERNELS_SSE2
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define DEPTHKERNELS_NEON
+#endif
+
+// known depths are shifted down by one so unknown (0) wraps around to the
+// largest value: 0 < depth < threshold becomes a single unsigned compare &
+// the nearest known depth is the unsigned minimum
+#if defined(DEPTHKERNELS_SSE2)
+// SSE2 only compares signed 16 bit ints, so flip the sign bit for unsigned
+static inline __m128i biasWords(__m128i v) {
+	return _mm_xor_si128(v, _mm_set1_epi16((short)0x8000));
+}
+
+// horizontal unsigned min of 8 words
+static inline std::uint16_t minWords(__m128i v) {
+	v = biasWords(v);
+	v = _mm_min_epi16(v, _mm_srli_si128(v, 8));
+	v = _mm_min_epi16(v, _mm_srli_si128(v, 4));
+	v = _mm_min_epi16(v, _mm_srli_si128(v, 2));
+	return (_mm_cvtsi128_si32(v) & 0xFFFF) ^ 0x8000;
+}
+#endif
+
+// threshold one row into the mask
+static void thresholdRow(const std::uint16_t *depth, std::uint8_t *mask,
+                         std::size_t width, std::uint16_t threshold) {
+	std::size_t x = 0;
+	const std::uint16_t t = threshold - 1;
+#if defined(__AVX2__)
+	{
+		const __m256i one = _mm256_set1_epi16(1);
+		const __m256i bias = _mm256_set1_epi16((short)0x8000);
+		const __m256i tb = _mm256_xor_si256(_mm256_set1_epi16((short)t), bias);
+		for(; x + 32 <= width; x += 32) {
+			__m256i a = _mm256_loadu_si256((const __m256i *)(depth + x));
+			__m256i b = _mm256_loadu_si256((const __m256i *)(depth + x + 16));
+			a = _mm256_xor_si256(_mm256_sub_epi16(a, one), bias);
+			b = _mm256_xor_si256(_mm256_sub_epi16(b, one), bias);
+			// pack works within 128 bit lanes, so put the quarters back in order
+			__m256i m = _mm256_packs_epi16(_mm256_cmpgt_epi16(tb, a), _mm256_cmpgt_epi16(tb, b));
+			_mm256_storeu_si256((__m256i *)(mask + x), _mm256_permute4x64_epi64(m, 0xD8));
+		}
+	}
+#endif
+#if defined(DEPTHKERNELS_SSE2)
+	{
+		const __m128i one = _mm_set1_epi16(1);
+		const __m128i tb = biasWords(_mm_set1_epi16((short)t));
+		for(; x + 16 <= width; x += 16) {
+			__m128i a = _mm_loadu_si128((const __m128i *)(depth + x));
+			__m128i b = _mm_loadu_si128((const __m128i *)(depth + x + 8));
+			a = biasWords(_mm_sub_epi16(a, one));
+			b = biasWords(_mm_sub_epi16(b, one));
+			__m128i m = _mm_packs_epi16(_mm_cmplt_epi16(a, tb), _mm_cmplt_epi16(b, tb));
+			_mm_storeu_si128((__m128i *)(mask + x), m);
+		}
+	}
+#elif defined(DEPTHKERNELS_NEON)
+	{
+		const uint16x8_t one = vdupq_n_u16(1);
+		const uint16x8_t tv = vdupq_n_u16(t);
+		for(; x + 16 <= width; x += 16) {
+			uint16x8_t a = vsubq_u16(vld1q_u16(depth + x), one);
+			uint16x8_t b = vsubq_u16(vld1q_u16(depth + x + 8), one);
+			uint8x16_t m = vcombine_u8(vmovn_u16(vcltq_u16(a, tv)), vmovn_u16(vcltq_u16(b, tv)));
+			vst1q_u8(mask + x, m);
+		}
+	}
+#endif
+	for(; x < width; ++x) {
+		mask[x] = ((std::uint16_t)(depth[x] - 1) < t) ? 0xFF : 0;
+	}
+}
+
+//--------------------------------------------------------------
+void thresholdDepth(const std::uint16_t *depth, std::size_t depthStride,
+                    std::uint8_t *mask, std::size_t maskStride,
+                    std::size_t width, std::size_t height,
+                    std::uint16_t threshold) {
+	for(std::size_t y = 0; y < height; ++y) {
+		if(threshold == 0) {
+			std::memset(mask + y * maskStride, 0, width); // nothing is nearer
+			continue;
+		}
+		thresholdRow(depth + y * depthStride, mask + y * maskStride, width, threshold);
+	}
+}
+
+// threshold one row against the background into the mask
+static void thresholdForegroundRow(const std::uint16_t *depth, const std::uint16_t *background,
+                                   std::uint8_t *mask, std::size_t width,
+                                   std::uint16_t threshold, std::uint16_t margin) {
+	std::size_t x = 0;
+	const std::uint16_t t = threshold - 1;
+#if defined(DEPTHKERNELS_SSE2)
+	{
+		const __m128i one = _mm_set1_epi16(1);
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i m = _mm_set1_epi16((short)margin);
+		const __m128i tb = biasWords(_mm_set1_epi16((short)t));
+		for(; x + 16 <= width; x += 16) {
+			__m128i result[2];
+			for(int i = 0; i < 2; ++i) {
+				__m128i d = _mm_loadu_si128((const __m128i *)(depth + x + i * 8));
+				__m128i b = _mm_loadu_si128((const __m128i *)(background + x + i * 8));
+				__m128i nearer = _mm_cmplt_epi16(biasWords(_mm_sub_epi16(d, one)), tb);
+				// background - 1 >= depth + margin, unknown background wraps around
+				__m128i fg = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_adds_epu16(d, m), _mm_sub_epi16(b, one)), zero);
+				result[i] = _mm_and_si128(nearer, fg);
+			}
+			_mm_storeu_si128((__m128i *)(mask + x), _mm_packs_epi16(result[0], result[1]));
+		}
+	}
+#elif defined(DEPTHKERNELS_NEON)
+	{
+		const uint16x8_t one = vdupq_n_u16(1);
+		const uint16x8_t m = vdupq_n_u16(margin);
+		const uint16x8_t tv = vdupq_n_u16(t);
+		for(; x + 16 <= width; x += 16) {
+			uint8x8_t result[2];
+			for(int i = 0; i < 2; ++i) {
+				uint16x8_t d = vld1q_u16(depth + x + i * 8);
+				uint16x8_t b = vsubq_u16(vld1q_u16(background + x + i * 8), one);
+				uint16x8_t nearer = vcltq_u16(vsubq_u16(d, one), tv);
+				uint16x8_t fg = vcgeq_u16(b, vqaddq_u16(d, m));
+				result[i] = vmovn_u16(vandq_u16(nearer, fg));
+			}
+			vst1q_u8(mask + x, vcombine_u8(result[0], result[1]));
+		}
+	}
+#endif
+	for(; x < width; ++x) {
+		std::uint16_t d = depth[x];
+		std::uint32_t dm = std::min((std::uint32_t)d + margin, (std::uint32_t)0xFFFF);
+		bool fg = (std::uint16_t)(background[x] - 1) >= dm;
+		mask[x] = ((std::uint16_t)(d - 1) < t && fg) ? 0xFF : 0;
+	}
+}
+
+//--------------------------------------------------------------
+void thresholdForeground(const std::uint16_t *depth, std::size_t depthStride,
+                         const std::uint16_t *background, std::size_t backgroundStride,
+                         std::uint8_t *mask, std::size_t maskStride,
+                         std::size_t width, std::size_t height,
+                         std::uint16_t threshold, std::uint16_t margin) {
+	for(std::size_t y = 0; y < height; ++y) {
+		if(threshold == 0) {
+			std::memset(mask + y * maskStride, 0, width); // nothing is nearer
+			continue;
+		}
+		thresholdForegroundRow(depth + y * depthStride, background + y * backgroundStride,
+		                       mask + y * maskStride, width, threshold, margin);
+	}
+}
+
+//--------------------------------------------------------------
+void updateBackground(const std::uint16_t *depth, std::uint16_t *background,
+                      std::size_t count, std::uint16_t rate) {
+	std::size_t i = 0;
+#if defined(DEPTHKERNELS_SSE2)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i r = _mm_set1_epi16((short)rate);
+		for(; i + 8 <= count; i += 8) {
+			__m128i d = _mm_loadu_si128((const __m128i *)(depth + i));
+			__m128i b = _mm_loadu_si128((const __m128i *)(background + i));
+			// step up or down by min(difference, rate), min(a, r) = a - (a -sat r)
+			__m128i up = _mm_subs_epu16(d, b);
+			__m128i down = _mm_subs_epu16(b, d);
+			up = _mm_sub_epi16(up, _mm_subs_epu16(up, r));
+			down = _mm_sub_epi16(down, _mm_subs_epu16(down, r));
+			__m128i next = _mm_sub_epi16(_mm_add_epi16(b, up), down);
+			// unknown background takes the depth, unknown depth keeps the background
+			__m128i unknown = _mm_cmpeq_epi16(b, zero);
+			next = _mm_or_si128(_mm_and_si128(unknown, d), _mm_andnot_si128(unknown, next));
+			__m128i noDepth = _mm_cmpeq_epi16(d, zero);
+			next = _mm_or_si128(_mm_and_si128(noDepth, b), _mm_andnot_si128(noDepth, next));
+			_mm_storeu_si128((__m128i *)(background + i), next);
+		}
+	}
+#elif defined(DEPTHKERNELS_NEON)
+	{
+		const uint16x8_t r = vdupq_n_u16(rate);
+		for(; i + 8 <= count; i += 8) {
+			uint16x8_t d = vld1q_u16(depth + i);
+			uint16x8_t b = vld1q_u16(background + i);
+			uint16x8_t up = vminq_u16(vqsubq_u16(d, b), r);
+			uint16x8_t down = vminq_u16(vqsubq_u16(b, d), r);
+			uint16x8_t next = vsubq_u16(vaddq_u16(b, up), down);
+			next = vbslq_u16(vceqq_u16(b, vdupq_n_u16(0)), d, next);
+			next = vbslq_u16(vceqq_u16(d, vdupq_n_u16(0)), b, next);
+			vst1q_u16(background + i, next);
+		}
+	}
+#endif
+	for(; i < count; ++i) {
+		std::uint16_t d = depth[i], b = background[i];
+		if(d == 0) {
+			continue;
+		}
+		if(b == 0) {
+			background[i] = d;
+		}
+		else if(d > b) {
+			background[i] = b + std::min<std::uint16_t>(d - b, rate);
+		}
+		else {
+			background[i] = b - std::min<std::uint16_t>(b - d, rate);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+int findNearest(const std::uint16_t *depth, std::size_t count) {
+	std::size_t x = 0;
+	std::uint16_t nearest = 0xFFFF; // shifted, so unknown
+#if defined(__AVX2__)
+	if(count >= 16) {
+		const __m256i one = _mm256_set1_epi16(1);
+		__m256i vmin = _mm256_set1_epi16((short)0xFFFF);
+		for(; x + 16 <= count; x += 16) {
+			__m256i v = _mm256_loadu_si256((const __m256i *)(depth + x));
+			vmin = _mm256_min_epu16(vmin, _mm256_sub_epi16(v, one));
+		}
+		__m128i m = _mm_min_epu16(_mm256_castsi256_si128(vmin), _mm256_extracti128_si256(vmin, 1));
+		nearest = _mm_extract_epi16(_mm_minpos_epu16(m), 0);
+	}
+#endif
+#if defined(DEPTHKERNELS_SSE2)
+	if(x + 8 <= count) {
+		const __m128i one = _mm_set1_epi16(1);
+		__m128i vmin = _mm_set1_epi16((short)0xFFFF);
+		for(; x + 8 <= count; x += 8) {
+			__m128i v = _mm_loadu_si128((const __m128i *)(depth + x));
+			vmin = biasWords(_mm_min_epi16(biasWords(vmin), biasWords(_mm_sub_epi16(v, one))));
+		}
+		std::uint16_t m = minWords(vmin);
+		if(m < nearest) {
+			nearest = m;
+		}
+	}
+#elif defined(DEPTHKERNELS_NEON)
+	if(x + 8 <= count) {
+		const uint16x8_t one = vdupq_n_u16(1);
+		uint16x8_t vmin = vdupq_n_u16(0xFFFF);
+		for(; x + 8 <= count; x += 8) {
+			vmin = vminq_u16(vmin, vsubq_u16(vld1q_u16(depth + x), one));
+		}
+	#if defined(__aarch64__)
+		std::uint16_t m = vminvq_u16(vmin);
+	#else
+		uint16x4_t h = vpmin_u16(vget_low_u16(vmin), vget_high_u16(vmin));
+		h = vpmin_u16(h, h);
+		h = vpmin_u16(h, h);
+		std::uint16_t m = vget_lane_u16(h, 0);
+	#endif
+		if(m < nearest) {
+			nearest = m;
+		}
+	}
+#endif
+	for(; x < count; ++x) {
+		std::uint16_t v = depth[x] - 1;
+		if(v < nearest) {
+			nearest = v;
+		}
+	}
+	if(nearest == 0xFFFF) {
+		return -1;
+	}
+
+	// the run was just read so it's still in cache
+	nearest++;
+	for(x = 0; depth[x] != nearest; ++x) {}
+	return x;
+}
+
+//--------------------------------------------------------------
+void downsampleDepth(const std::uint16_t *depth, std::size_t depthStride,
+                     std::uint16_t *half, std::size_t halfStride,
+                     std::size_t width, std::size_t height) {
+	for(std::size_t y = 0; y < height; ++y) {
+		const std::uint16_t *row0 = depth + (y * 2) * depthStride;
+		const std::uint16_t *row1 = row0 + depthStride;
+		std::uint16_t *out = half + y * halfStride;
+		std::size_t x = 0;
+#if defined(DEPTHKERNELS_SSE2)
+		{
+			const __m128i one = _mm_set1_epi16(1);
+			for(; x + 8 <= width; x += 8) {
+				// shifted & biased, so a signed min is the nearest known depth
+				__m128i a = _mm_min_epi16(
+					biasWords(_mm_sub_epi16(_mm_loadu_si128((const __m128i *)(row0 + x * 2)), one)),
+					biasWords(_mm_sub_epi16(_mm_loadu_si128((const __m128i *)(row1 + x * 2)), one)));
+				__m128i b = _mm_min_epi16(
+					biasWords(_mm_sub_epi16(_mm_loadu_si128((const __m128i *)(row0 + x * 2 + 8)), one)),
+					biasWords(_mm_sub_epi16(_mm_loadu_si128((const __m128i *)(row1 + x * 2 + 8)), one)));
+				// min of each horizontal pair ends up in the low word, sign
+				// extend those so the pack doesn't saturate
+				a = _mm_min_epi16(a, _mm_srli_epi32(a, 16));
+				b = _mm_min_epi16(b, _mm_srli_epi32(b, 16));
+				a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+				b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+				__m128i m = _mm_add_epi16(biasWords(_mm_packs_epi32(a, b)), one);
+				_mm_storeu_si128((__m128i *)(out + x), m);
+			}
+		}
+#elif defined(DEPTHKERNELS_NEON)
+		{
+			const uint16x8_t one = vdupq_n_u16(1);
+			for(; x + 8 <= width; x += 8) {
+				// deinterleave even & odd pixels
+				uint16x8x2_t a = vld2q_u16(row0 + x * 2);
+				uint16x8x2_t b = vld2q_u16(row1 + x * 2);
+				uint16x8_t m = vminq_u16(vminq_u16(vsubq_u16(a.val[0], one), vsubq_u16(a.val[1], one)),
+				                         vminq_u16(vsubq_u16(b.val[0], one), vsubq_u16(b.val[1], one)));
+				vst1q_u16(out + x, vaddq_u16(m, one));
+			}
+		}
+#endif
+		for(; x < width; ++x) {
+			std::uint16_t m = std::min(std::min<std::uint16_t>(row0[x * 2] - 1, row0[x * 2 + 1] - 1),
+			                           std::min<std::uint16_t>(row1[x * 2] - 1, row1[x * 2 + 1] - 1));
+			out[x] = m + 1;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void differenceTiles(const std::uint16_t *a, std::size_t aStride,
+                     const std::uint16_t *b, std::size_t bStride,
+                     std::size_t width, std::size_t height,
+                     std::uint16_t tolerance, std::uint32_t *sums) {
+	const std::size_t TILE = DEPTHKERNELS_TILE_SIZE;
+	std::size_t numTiles = (width + TILE - 1) / TILE;
+	std::size_t tile = 0; // first tile left for the scalar fallback
+#if defined(DEPTHKERNELS_SSE2) || defined(DEPTHKERNELS_NEON)
+	// full tiles in chunks, reading the rows in order & keeping a vector sum
+	// per tile, summed once at the end
+	static const std::size_t CHUNK = 64; // tiles
+	std::size_t fullTiles = width / TILE;
+	while(tile < fullTiles) {
+		std::size_t n = std::min(CHUNK, fullTiles - tile);
+	#if defined(DEPTHKERNELS_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i t = _mm_set1_epi16((short)tolerance);
+		__m128i acc[CHUNK];
+		for(std::size_t i = 0; i < n; ++i) {
+			acc[i] = zero;
+		}
+		for(std::size_t y = 0; y < height; ++y) {
+			const std::uint16_t *rowA = a + y * aStride + tile * TILE;
+			const std::uint16_t *rowB = b + y * bStride + tile * TILE;
+			for(std::size_t i = 0; i < n; ++i) {
+				__m128i a0 = _mm_loadu_si128((const __m128i *)(rowA + i * TILE));
+				__m128i b0 = _mm_loadu_si128((const __m128i *)(rowB + i * TILE));
+				__m128i a1 = _mm_loadu_si128((const __m128i *)(rowA + i * TILE + 8));
+				__m128i b1 = _mm_loadu_si128((const __m128i *)(rowB + i * TILE + 8));
+				// |a - b| -sat tolerance, widened to 32 bits as madd is signed
+				__m128i d0 = _mm_subs_epu16(_mm_or_si128(_mm_subs_epu16(a0, b0), _mm_subs_epu16(b0, a0)), t);
+				__m128i d1 = _mm_subs_epu16(_mm_or_si128(_mm_subs_epu16(a1, b1), _mm_subs_epu16(b1, a1)), t);
+				acc[i] = _mm_add_epi32(acc[i],
+					_mm_add_epi32(_mm_add_epi32(_mm_unpacklo_epi16(d0, zero), _mm_unpackhi_epi16(d0, zero)),
+					              _mm_add_epi32(_mm_unpacklo_epi16(d1, zero), _mm_unpackhi_epi16(d1, zero))));
+			}
+		}
+		for(std::size_t i = 0; i < n; ++i) {
+			__m128i v = _mm_add_epi32(acc[i], _mm_srli_si128(acc[i], 8));
+			v = _mm_add_epi32(v, _mm_srli_si128(v, 4));
+			sums[tile + i] = (std::uint32_t)_mm_cvtsi128_si32(v);
+		}
+		tile += n;
+	#else
+		const uint16x8_t t = vdupq_n_u16(tolerance);
+		uint32x4_t acc[CHUNK];
+		for(std::size_t i = 0; i < n; ++i) {
+			acc[i] = vdupq_n_u32(0);
+		}
+		for(std::size_t y = 0; y < height; ++y) {
+			const std::uint16_t *rowA = a + y * aStride + tile * TILE;
+			const std::uint16_t *rowB = b + y * bStride + tile * TILE;
+			for(std::size_t i = 0; i < n; ++i) {
+				uint16x8_t d0 = vabdq_u16(vld1q_u16(rowA + i * TILE), vld1q_u16(rowB + i * TILE));
+				uint16x8_t d1 = vabdq_u16(vld1q_u16(rowA + i * TILE + 8), vld1q_u16(rowB + i * TILE + 8));
+				acc[i] = vpadalq_u16(vpadalq_u16(acc[i], vqsubq_u16(d0, t)), vqsubq_u16(d1, t));
+			}
+		}
+		for(std::size_t i = 0; i < n; ++i) {
+		#if defined(__aarch64__)
+			sums[tile + i] = vaddvq_u32(acc[i]);
+		#else
+			uint32x2_t h = vadd_u32(vget_low_u32(acc[i]), vget_high_u32(acc[i]));
+			sums[tile + i] = vget_lane_u32(vpadd_u32(h, h), 0);
+		#endif
+		}
+		tile += n;
+	#endif
+	}
+#endif
+	for(; tile < numTiles; ++tile) {
+		std::size_t x0 = tile * TILE, x1 = std::min(x0 + TILE, width);
+		std::uint32_t sum = 0;
+		for(std::size_t y = 0; y < height; ++y) {
+			for(std::size_t x = x0; x < x1; ++x) {
+				int d = std::abs((int)a[y * aStride + x] - (int)b[y * bStride + x]) - tolerance;
+				if(d > 0) {
+					sum += d;
+				}
+			}
+		}
+		sums[tile] = sum;
+	}
+}
+
+//--------------------------------------------------------------
+void fillDepthHoles(const std::uint16_t *a, const std::uint16_t *b, const std::uint16_t *c,
+                    std::uint16_t *out, std::size_t count) {
+	std::size_t i = 0;
+#if defined(DEPTHKERNELS_SSE2)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		for(; i + 8 <= count; i += 8) {
+			__m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+			__m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+			__m128i vc = _mm_loadu_si128((const __m128i *)(c + i));
+			// unsigned max(a, c) = a + (c -sat a)
+			__m128i far = _mm_add_epi16(va, _mm_subs_epu16(vc, va));
+			__m128i hole = _mm_cmpeq_epi16(vb, zero);
+			_mm_storeu_si128((__m128i *)(out + i),
+			                 _mm_or_si128(_mm_and_si128(hole, far), _mm_andnot_si128(hole, vb)));
+		}
+	}
+#elif defined(DEPTHKERNELS_NEON)
+	for(; i + 8 <= count; i += 8) {
+		uint16x8_t vb = vld1q_u16(b + i);
+		uint16x8_t far = vmaxq_u16(vld1q_u16(a + i), vld1q_u16(c + i));
+		vst1q_u16(out + i, vbslq_u16(vceqq_u16(vb, vdupq_n_u16(0)), far, vb));
+	}
+#endif
+	for(; i < count; ++i) {
+		out[i] = (b[i] != 0 ? b[i] : std::max(a[i], c[i]));
+	}
+}
+
+// median of 3 from min & max: max(min(a, b), min(max(a, b), c))
+// median of 5 is the median of 3 of e & the middle two of a b c d
+#if defined(DEPTHKERNELS_SSE2)
+// biased, so signed compares
+static inline __m128i median3(__m128i a, __m128i b, __m128i c) {
+	return _mm_max_epi16(_mm_min_epi16(a, b), _mm_min_epi16(_mm_max_epi16(a, b), c));
+}
+#elif defined(DEPTHKERNELS_NEON)
+static inline uint16x8_t median3(uint16x8_t a, uint16x8_t b, uint16x8_t c) {
+	return vmaxq_u16(vminq_u16(a, b), vminq_u16(vmaxq_u16(a, b), c));
+}
+#endif
+static inline std::uint16_t median3(std::uint16_t a, std::uint16_t b, std::uint16_t c) {
+	return std::max(std::min(a, b), std::min(std::max(a, b), c));
+}
+
+//--------------------------------------------------------------
+void medianDepth3(const std::uint16_t *a, const std::uint16_t *b, const std::uint16_t *c,
+                  std::uint16_t *out, std::size_t count) {
+	std::size_t i = 0;
+#if defined(DEPTHKERNELS_SSE2)
+	for(; i + 8 <= count; i += 8) {
+		__m128i m = median3(biasWords(_mm_loadu_si128((const __m128i *)(a + i))),
+		                    biasWords(_mm_loadu_si128((const __m128i *)(b + i))),
+		                    biasWords(_mm_loadu_si128((const __m128i *)(c + i))));
+		_mm_storeu_si128((__m128i *)(out + i), biasWords(m));
+	}
+#elif defined(DEPTHKERNELS_NEON)
+	for(; i + 8 <= count; i += 8) {
+		vst1q_u16(out + i, median3(vld1q_u16(a + i), vld1q_u16(b + i), vld1q_u16(c + i)));
+	}
+#endif
+	for(; i < count; ++i) {
+		out[i] = median3(a[i], b[i], c[i]);
+	}
+}
+
+//--------------------------------------------------------------
+void medianDepth5(const std::uint16_t *a, const std::uint16_t *b, const std::uint16_t *c,
+                  const std::uint16_t *d, const std::uint16_t *e,
+                  std::uint16_t *out, std::size_t count) {
+	std::size_t i = 0;
+#if defined(DEPTHKERNELS_SSE2)
+	for(; i + 8 <= count; i += 8) {
+		__m128i va = biasWords(_mm_loadu_si128((const __m128i *)(a + i)));
+		__m128i vb = biasWords(_mm_loadu_si128((const __m128i *)(b + i)));
+		__m128i vc = biasWords(_mm_loadu_si128((const __m128i *)(c + i)));
+		__m128i vd = biasWords(_mm_loadu_si128((const __m128i *)(d + i)));
+		__m128i f = _mm_max_epi16(_mm_min_epi16(va, vb), _mm_min_epi16(vc, vd));
+		__m128i g = _mm_min_epi16(_mm_max_epi16(va, vb), _mm_max_epi16(vc, vd));
+		__m128i m = median3(biasWords(_mm_loadu_si128((const __m128i *)(e + i))), f, g);
+		_mm_storeu_si128((__m128i *)(out + i), biasWords(m));
+	}
+#elif defined(DEPTHKERNELS_NEON)
+	for(; i + 8 <= count; i += 8) {
+		uint16x8_t va = vld1q_u16(a + i), vb = vld1q_u16(b + i);
+		uint16x8_t vc = vld1q_u16(c + i), vd = vld1q_u16(d + i);
+		uint16x8_t f = vmaxq_u16(vminq_u16(va, vb), vminq_u16(vc, vd));
+		uint16x8_t g = vminq_u16(vmaxq_u16(va, vb), vmaxq_u16(vc, vd));
+		vst1q_u16(out + i, median3(vld1q_u16(e + i), f, g));
+	}
+#endif
+	for(; i < count; ++i) {
+		std::uint16_t f = std::max(std::min(a[i], b[i]), std::min(c[i], d[i]));
+		std::uint16_t g = std::min(std::max(a[i], b[i]), std::max(c[i], d[i]));
+		out[i] = median3(e[i], f, g);
+	}
+}
+
+//--------------------------------------------------------------
+void smoothDepth(const std::uint16_t *depth, std::uint16_t *smoothed, std::size_t count,
+                 std::uint16_t weight, std::uint16_t jump) {
+	std::size_t i = 0;
+#if defined(DEPTHKERNELS_SSE2)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i w = _mm_set1_epi16((short)weight);
+		const __m128i j = _mm_set1_epi16((short)jump);
+		const __m128i half = _mm_set1_epi32(128);
+		for(; i + 8 <= count; i += 8) {
+			__m128i d = _mm_loadu_si128((const __m128i *)(depth + i));
+			__m128i s = _mm_loadu_si128((const __m128i *)(smoothed + i));
+			// difference * weight in 32 bits from the low & high halves, only
+			// used where the difference is within the jump so it fits 16 bits
+			__m128i diff = _mm_sub_epi16(d, s);
+			__m128i lo = _mm_mullo_epi16(diff, w);
+			__m128i hi = _mm_mulhi_epi16(diff, w);
+			__m128i p0 = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), half), 8);
+			__m128i p1 = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), half), 8);
+			__m128i next = _mm_add_epi16(s, _mm_packs_epi32(p0, p1));
+			// unknown or jumped takes the depth
+			__m128i distance = _mm_or_si128(_mm_subs_epu16(d, s), _mm_subs_epu16(s, d));
+			__m128i take = _mm_or_si128(_mm_cmpeq_epi16(d, zero), _mm_cmpeq_epi16(s, zero));
+			take = _mm_or_si128(take, _mm_xor_si128(_mm_cmpeq_epi16(_mm_subs_epu16(distance, j), zero),
+			                                        _mm_set1_epi16(-1)));
+			next = _mm_or_si128(_mm_and_si128(take, d), _mm_andnot_si128(take, next));
+			_mm_storeu_si128((__m128i *)(smoothed + i), next);
+		}
+	}
+#elif defined(DEPTHKERNELS_NEON)
+	{
+		const int16x4_t w = vdup_n_s16((std::int16_t)weight);
+		const uint16x8_t j = vdupq_n_u16(jump);
+		const uint16x8_t zero = vdupq_n_u16(0);
+		for(; i + 8 <= count; i += 8) {
+			uint16x8_t d = vld1q_u16(depth + i);
+			uint16x8_t s = vld1q_u16(smoothed + i);
+			int16x8_t diff = vreinterpretq_s16_u16(vsubq_u16(d, s));
+			int16x4_t lo = vrshrn_n_s32(vmull_s16(vget_low_s16(diff), w), 8);
+			int16x4_t hi = vrshrn_n_s32(vmull_s16(vget_high_s16(diff), w), 8);
+			uint16x8_t next = vaddq_u16(s, vreinterpretq_u16_s16(vcombine_s16(lo, hi)));
+			uint16x8_t take = vorrq_u16(vceqq_u16(d, zero), vceqq_u16(s, zero));
+			take = vorrq_u16(take, vcgtq_u16(vabdq_u16(d, s), j));
+			vst1q_u16(smoothed + i, vbslq_u16(take, d, next));
+		}
+	}
+#endif
+	for(; i < count; ++i) {
+		int d = depth[i], s = smoothed[i];
+		if(d == 0 || s == 0 || std::abs(d - s) > jump) {
+			smoothed[i] = d;
+		}
+		else {
+			smoothed[i] = s + (((d - s) * weight + 128) >> 8);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void unprojectDepth(const std::uint16_t *depth, const float *rayX, const float *rayY,
+                    float *x, float *y, float *z, std::size_t count) {
+	std::size_t i = 0;
+#if defined(__AVX2__)
+	for(; i + 8 <= count; i += 8) {
+		__m128i d = _mm_loadu_si128((const __m128i *)(depth + i));
+		__m256 w = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(d));
+		_mm256_storeu_ps(x + i, _mm256_mul_ps(_mm256_loadu_ps(rayX + i), w));
+		_mm256_storeu_ps(y + i, _mm256_mul_ps(_mm256_loadu_ps(rayY + i), w));
+		_mm256_storeu_ps(z + i, w);
+	}
+#endif
+#if defined(DEPTHKERNELS_SSE2)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		for(; i + 8 <= count; i += 8) {
+			__m128i d = _mm_loadu_si128((const __m128i *)(depth + i));
+			__m128 lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(d, zero));
+			__m128 hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(d, zero));
+			_mm_storeu_ps(x + i, _mm_mul_ps(_mm_loadu_ps(rayX + i), lo));
+			_mm_storeu_ps(x + i + 4, _mm_mul_ps(_mm_loadu_ps(rayX + i + 4), hi));
+			_mm_storeu_ps(y + i, _mm_mul_ps(_mm_loadu_ps(rayY + i), lo));
+			_mm_storeu_ps(y + i + 4, _mm_mul_ps(_mm_loadu_ps(rayY + i + 4), hi));
+			_mm_storeu_ps(z + i, lo);
+			_mm_storeu_ps(z + i + 4, hi);
+		}
+	}
+#elif defined(DEPTHKERNELS_NEON)
+	for(; i + 8 <= count; i += 8) {
+		uint16x8_t d = vld1q_u16(depth + i);
+		float32x4_t lo = vcvtq_f32_u32(vmovl_u16(vget_low_u16(d)));
+		float32x4_t hi = vcvtq_f32_u32(vmovl_u16(vget_high_u16(d)));
+		vst1q_f32(x + i, vmulq_f32(vld1q_f32(rayX + i), lo));
+		vst1q_f32(x + i + 4, vmulq_f32(vld1q_f32(rayX + i + 4), hi));
+		vst1q_f32(y + i, vmulq_f32(vld1q_f32(rayY + i), lo));
+		vst1q_f32(y + i + 4, vmulq_f32(vld1q_f32(rayY + i + 4), hi));
+		vst1q_f32(z + i, lo);
+		vst1q_f32(z + i + 4, hi);
+	}
+#endif
+	for(; i < count; ++i) {
+		float w = depth[i];
+		x[i] = rayX[i] * w;
+		y[i] = rayY[i] * w;
+		z[i] = w;
+	}
+}
+
+//--------------------------------------------------------------
+void buildDepthLookup(std::uint8_t *lookup, std::size_t size,
+                      float nearClipping, float farClipping) {
+	if(size == 0) {
+		return;
+	}
+	lookup[0] = 0;
+	for(std::size_t i = 1; i < size; ++i) {
+		float v = 255 - (i - nearClipping) / (farClipping - nearClipping) * 255;
+		lookup[i] = (v < 0 ? 0 : (v > 255 ? 255 : v));
+	}
+}
+
+//--------------------------------------------------------------
+void convertDepth(const std::uint16_t *raw, std::uint8_t *depth, std::size_t count,
+                  const std::uint8_t *lookup, std::size_t size) {
+	for(std::size_t i = 0; i < count; ++i) {
+		depth[i] = lookup[raw[i] < size ? raw[i] : size-1];
+	}
+}
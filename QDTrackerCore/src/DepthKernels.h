@@ -0,0 +1,126 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// vectorized per-frame depth image kernels, working on raw kinect depth in mm
+//
+// SSE2 is used on x86, AVX2 when built with -mavx2 (or -march=native), and
+// NEON on ARM, with a plain C++ fallback for everything else
+
+// threshold raw depth into a binary mask: 255 where 0 < depth < threshold (a
+// known depth nearer than the threshold) otherwise 0
+//
+// depthStride is in pixels, maskStride in bytes
+void thresholdDepth(const std::uint16_t *depth, std::size_t depthStride,
+                    std::uint8_t *mask, std::size_t maskStride,
+                    std::size_t width, std::size_t height,
+                    std::uint16_t threshold);
+
+// threshold raw depth against a background model into a binary mask: 255
+// where 0 < depth < threshold & depth + margin < background (nearer than the
+// background by more than the margin) otherwise 0, unknown (0) background
+// pixels are always foreground
+//
+// depthStride & backgroundStride are in pixels, maskStride in bytes
+void thresholdForeground(const std::uint16_t *depth, std::size_t depthStride,
+                         const std::uint16_t *background, std::size_t backgroundStride,
+                         std::uint8_t *mask, std::size_t maskStride,
+                         std::size_t width, std::size_t height,
+                         std::uint16_t threshold, std::uint16_t margin);
+
+// move each background depth towards the known (non-zero) raw depth by at most
+// rate mm, an approximate running median: unknown background pixels take the
+// depth straight away
+void updateBackground(const std::uint16_t *depth, std::uint16_t *background,
+                      std::size_t count, std::uint16_t rate);
+
+// index of the first nearest known (non-zero) depth in a run of raw depth
+// pixels, -1 if they are all unknown
+int findNearest(const std::uint16_t *depth, std::size_t count);
+
+// halve raw depth by taking the nearest known (non-zero) depth of each 2x2
+// block, 0 if all 4 are unknown: nearer things never shrink away when
+// downsampling, so a person stays a person at each level of a pyramid
+//
+// width & height are the downsampled size, the source must have at least twice
+// as many pixels in each direction, strides are in pixels
+void downsampleDepth(const std::uint16_t *depth, std::size_t depthStride,
+                     std::uint16_t *half, std::size_t halfStride,
+                     std::size_t width, std::size_t height);
+
+// change detection tile width in pixels
+#define DEPTHKERNELS_TILE_SIZE 16
+
+// sums of absolute differences between two rows of raw depth tiles beyond a
+// per pixel noise tolerance, the sum of max(|a - b| - tolerance, 0) over each
+// tile: the rows are split into DEPTHKERNELS_TILE_SIZE wide tiles, the last
+// may be narrower, with a sum per tile, which is 32 bits so keep them small
+//
+// strides are in pixels
+void differenceTiles(const std::uint16_t *a, std::size_t aStride,
+                     const std::uint16_t *b, std::size_t bStride,
+                     std::size_t width, std::size_t height,
+                     std::uint16_t tolerance, std::uint32_t *sums);
+
+// fill unknown (0) depth in b from the farther of its neighbours in a & c,
+// elementwise, ie. the pixels either side or the rows above & below: kinect
+// holes are mostly the shadows nearer things cast on what's behind them, so
+// this never grows a person into a hole
+void fillDepthHoles(const std::uint16_t *a, const std::uint16_t *b, const std::uint16_t *c,
+                    std::uint16_t *out, std::size_t count);
+
+// elementwise median of 3 or 5 runs of depth, ie. shifted pixels in a row or
+// neighbouring rows for one pass of a separable median
+void medianDepth3(const std::uint16_t *a, const std::uint16_t *b, const std::uint16_t *c,
+                  std::uint16_t *out, std::size_t count);
+void medianDepth5(const std::uint16_t *a, const std::uint16_t *b, const std::uint16_t *c,
+                  const std::uint16_t *d, const std::uint16_t *e,
+                  std::uint16_t *out, std::size_t count);
+
+// exponentially smooth depth over time in place: smoothed moves towards the
+// depth by weight/256 of the difference, taking the depth straight away when
+// either is unknown (0) or they differ by more than jump mm, so moving things
+// don't leave a trail
+//
+// weight is 0-256, jump is at most 0x7FFF
+void smoothDepth(const std::uint16_t *depth, std::uint16_t *smoothed, std::size_t count,
+                 std::uint16_t weight, std::uint16_t jump);
+
+// unproject a run of raw depth pixels to camera coordinates in mm with their
+// per-pixel rays, see DepthRays: x = rayX * depth, y = rayY * depth, z = depth,
+// unknown (0) depth gives 0, 0, 0
+void unprojectDepth(const std::uint16_t *depth, const float *rayX, const float *rayY,
+                    float *x, float *y, float *z, std::size_t count);
+
+// grayscale lookup for raw depth in mm, mapped the same way as ofxKinect: near
+// white, far black, & 0 (unknown) black, ie. for display
+//
+// lookup must have room for size entries, ie. max depth + 1
+void buildDepthLookup(std::uint8_t *lookup, std::size_t size,
+                      float nearClipping, float farClipping);
+
+// convert raw depth in mm to grayscale with a lookup from buildDepthLookup()
+void convertDepth(const std::uint16_t *raw, std::uint8_t *depth, std::size_t count,
+                  const std::uint8_t *lookup, std::size_t size);
@@ -0,0 +1,89 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "DepthRays.h"
+
+#include "DepthKernels.h"
+
+//--------------------------------------------------------------
+void DepthRays::setup(std::size_t width, std::size_t height,
+                      float zeroPlanePixelSize, float zeroPlaneDistance) {
+	if(zeroPlanePixelSize <= 0 || zeroPlaneDistance <= 0) {
+		zeroPlanePixelSize = KINECT_ZERO_PLANE_PIXEL_SIZE;
+		zeroPlaneDistance = KINECT_ZERO_PLANE_DISTANCE;
+	}
+	this->width = width;
+	this->height = height;
+	rayX.resize(width * height);
+	rayY.resize(width * height);
+
+	// as libfreenect's freenect_camera_to_world(): each pixel covers twice the
+	// zero plane pixel size at the zero plane distance
+	float factor = 2 * zeroPlanePixelSize / zeroPlaneDistance;
+	for(std::size_t y = 0; y < height; ++y) {
+		for(std::size_t x = 0; x < width; ++x) {
+			rayX[y * width + x] = ((float)x - width / 2) * factor;
+			rayY[y * width + x] = ((float)y - height / 2) * factor;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void DepthRays::unproject(Position *positions, std::size_t count) const {
+	const std::size_t BATCH = 32; // on the stack, more than enough for the persons
+	std::uint16_t depth[BATCH];
+	float batchRayX[BATCH], batchRayY[BATCH], x[BATCH], y[BATCH], z[BATCH];
+	for(std::size_t start = 0; start < count; start += BATCH) {
+		std::size_t n = (count - start < BATCH ? count - start : BATCH);
+		for(std::size_t i = 0; i < n; ++i) {
+			const Position &p = positions[start + i];
+			std::size_t index = pixel(p.x, p.y);
+			depth[i] = (p.z <= 0 ? 0 : (p.z >= 65535 ? 65535 : (std::uint16_t)(p.z + 0.5f)));
+			batchRayX[i] = rayX[index];
+			batchRayY[i] = rayY[index];
+		}
+		unprojectDepth(depth, batchRayX, batchRayY, x, y, z, n);
+		for(std::size_t i = 0; i < n; ++i) {
+			Position &p = positions[start + i];
+			p.x = x[i];
+			p.y = y[i];
+			p.z = z[i];
+		}
+	}
+}
+
+//--------------------------------------------------------------
+Position DepthRays::unprojectAt(const DepthFrame &frame, float x, float y) const {
+	Position p;
+	std::size_t index = pixel(x, y);
+	p.z = frame.raw[(index / width) * frame.rawStride + index % width];
+	p.x = rayX[index] * p.z;
+	p.y = rayY[index] * p.z;
+	return p;
+}
+
+//--------------------------------------------------------------
+std::size_t DepthRays::pixel(float x, float y) const {
+	int px = (int)(x + 0.5f), py = (int)(y + 0.5f);
+	px = (px < 0 ? 0 : (px >= (int)width ? (int)width - 1 : px));
+	py = (py < 0 ? 0 : (py >= (int)height ? (int)height - 1 : py));
+	return py * width + px;
+}
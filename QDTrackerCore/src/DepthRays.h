@@ -0,0 +1,75 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "Estimator.h"
+
+// typical kinect intrinsics, if the camera or recording doesn't have them
+#define KINECT_ZERO_PLANE_PIXEL_SIZE 0.1042f // mm
+#define KINECT_ZERO_PLANE_DISTANCE 120.0f    // mm
+
+// per-pixel camera ray lookup computed once from the depth camera intrinsics,
+// stored as a structure of arrays: camera coordinates in mm are the ray times
+// the depth, so unprojecting is one multiply per axis instead of a per-point
+// library call
+//
+// uses the same model & axes as ofxKinect's getWorldCoordinateAt(): the
+// origin is at the camera, x right, y down, & z the depth
+class DepthRays {
+
+	public:
+
+		// compute the rays for the frame size from ofxKinect's zero plane pixel
+		// size & distance in mm, typical kinect values if either is 0
+		void setup(std::size_t width, std::size_t height,
+		           float zeroPlanePixelSize, float zeroPlaneDistance);
+
+		bool isSetup() const {return !rayX.empty();}
+
+		// unproject image positions, x & y in pixels & z the depth in mm, in
+		// place using the ray of the nearest pixel: the rays & depths are
+		// gathered & unprojected in batches with unprojectDepth(), unknown (0)
+		// depth gives 0, 0, 0
+		void unproject(Position *positions, std::size_t count) const;
+
+		// unproject the pixel nearest to x & y using its depth in the frame
+		Position unprojectAt(const DepthFrame &frame, float x, float y) const;
+
+		// rays, per pixel in row order
+		const float* getRayX() const {return rayX.data();}
+		const float* getRayY() const {return rayY.data();}
+
+		std::size_t getWidth() const {return width;}
+		std::size_t getHeight() const {return height;}
+
+	private:
+
+		// nearest pixel index, clamped to the frame
+		std::size_t pixel(float x, float y) const;
+
+		std::vector<float> rayX, rayY; // per pixel
+		std::size_t width = 0, height = 0;
+};
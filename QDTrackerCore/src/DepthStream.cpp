@@ -0,0 +1,314 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "DepthStream.h"
+
+#include <cstring>
+#include <cerrno>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static_assert(sizeof(DepthStreamHeader) == 64, "DepthStreamHeader must be 64 bytes");
+static_assert(sizeof(DepthFrameHeader) == 16, "DepthFrameHeader must be 16 bytes");
+
+// grow recordings by this many frames at a time, ~40 MB of depth
+#define RECORDER_CHUNK 64
+
+// DepthStream
+
+//--------------------------------------------------------------
+std::size_t DepthStream::frameSize(std::size_t width, std::size_t height, bool rgb) {
+	std::size_t size = sizeof(DepthFrameHeader) + width * height * sizeof(std::uint16_t);
+	if(rgb) {
+		size += width * height * 3;
+	}
+	return (size + 63) & ~(std::size_t)63;
+}
+
+//--------------------------------------------------------------
+bool DepthStream::map(std::size_t size, bool writable) {
+	int prot = writable ? PROT_READ|PROT_WRITE : PROT_READ;
+	void *mem = mmap(nullptr, size, prot, writable ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+	if(mem == MAP_FAILED) {
+		setError("couldn't map file");
+		return false;
+	}
+	data = (std::uint8_t *)mem;
+	mapped = size;
+	return true;
+}
+
+//--------------------------------------------------------------
+void DepthStream::unmap() {
+	if(data) {
+		munmap(data, mapped);
+		data = nullptr;
+		mapped = 0;
+	}
+}
+
+//--------------------------------------------------------------
+void DepthStream::setError(const std::string &message) {
+	error = message;
+	if(errno != 0) {
+		error += ": " + std::string(strerror(errno));
+	}
+}
+
+// DepthRecorder
+
+//--------------------------------------------------------------
+DepthRecorder::~DepthRecorder() {
+	close();
+}
+
+//--------------------------------------------------------------
+bool DepthRecorder::open(const std::string &path, std::size_t width, std::size_t height,
+                         bool rgb, float zeroPlanePixelSize, float zeroPlaneDistance) {
+	close();
+	errno = 0;
+	fd = ::open(path.c_str(), O_RDWR|O_CREAT|O_TRUNC, 0644);
+	if(fd < 0) {
+		setError("couldn't create " + path);
+		return false;
+	}
+	this->path = path;
+
+	// header goes in before the first chunk of frames
+	DepthStreamHeader h = {};
+	std::memcpy(h.magic, DEPTHSTREAM_MAGIC, 4);
+	h.version = DEPTHSTREAM_VERSION;
+	h.width = width;
+	h.height = height;
+	h.flags = rgb ? HAS_RGB : 0;
+	h.frameCount = 0;
+	h.frameSize = frameSize(width, height, rgb);
+	h.zeroPlanePixelSize = zeroPlanePixelSize;
+	h.zeroPlaneDistance = zeroPlaneDistance;
+	if(::write(fd, &h, sizeof(h)) != sizeof(h) || !grow(RECORDER_CHUNK)) {
+		if(error.empty()) {
+			setError("couldn't write header to " + path);
+		}
+		close();
+		return false;
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+void DepthRecorder::close() {
+	if(fd < 0) {
+		return;
+	}
+	std::size_t size = sizeof(DepthStreamHeader);
+	if(data) {
+		size += header()->frameCount * header()->frameSize;
+		msync(data, mapped, MS_SYNC);
+	}
+	unmap();
+	if(ftruncate(fd, size) != 0) {
+		setError("couldn't trim " + path);
+	}
+	::close(fd);
+	fd = -1;
+	capacity = 0;
+	startTime = 0;
+}
+
+//--------------------------------------------------------------
+bool DepthRecorder::addFrame(const std::uint16_t *depth, const std::uint8_t *rgb,
+                             std::uint64_t timestamp, std::uint32_t sequence) {
+	if(!isOpen()) {
+		return false;
+	}
+	std::size_t index = header()->frameCount;
+	if(index >= capacity && !grow(RECORDER_CHUNK)) {
+		return false;
+	}
+	if(index == 0) {
+		startTime = timestamp;
+	}
+
+	std::uint8_t *f = frame(index);
+	DepthFrameHeader *fh = (DepthFrameHeader *)f;
+	fh->timestamp = timestamp - startTime;
+	fh->sequence = sequence;
+	fh->reserved = 0;
+	std::memcpy(f + sizeof(DepthFrameHeader), depth, depthSize());
+	if(hasRGB()) {
+		std::uint8_t *dst = f + sizeof(DepthFrameHeader) + depthSize();
+		if(rgb) {
+			std::memcpy(dst, rgb, getWidth() * getHeight() * 3);
+		}
+		else {
+			std::memset(dst, 0, getWidth() * getHeight() * 3);
+		}
+	}
+	header()->frameCount = index + 1;
+	return true;
+}
+
+//--------------------------------------------------------------
+bool DepthRecorder::grow(std::size_t frames) {
+	std::size_t width, height, size;
+	bool rgb;
+	if(data) {
+		width = getWidth();
+		height = getHeight();
+		rgb = hasRGB();
+	}
+	else { // first chunk, read back the header written by open()
+		DepthStreamHeader h;
+		if(pread(fd, &h, sizeof(h), 0) != sizeof(h)) {
+			setError("couldn't read header from " + path);
+			return false;
+		}
+		width = h.width;
+		height = h.height;
+		rgb = h.flags & HAS_RGB;
+	}
+	capacity += frames;
+	size = sizeof(DepthStreamHeader) + capacity * frameSize(width, height, rgb);
+	unmap();
+	errno = 0;
+	if(ftruncate(fd, size) != 0) {
+		setError("couldn't grow " + path);
+		return false;
+	}
+	return map(size, true);
+}
+
+// DepthPlayer
+
+//--------------------------------------------------------------
+DepthPlayer::~DepthPlayer() {
+	close();
+}
+
+//--------------------------------------------------------------
+bool DepthPlayer::open(const std::string &path) {
+	close();
+	errno = 0;
+	fd = ::open(path.c_str(), O_RDONLY);
+	if(fd < 0) {
+		setError("couldn't open " + path);
+		return false;
+	}
+	struct stat st;
+	if(fstat(fd, &st) != 0 || (std::size_t)st.st_size < sizeof(DepthStreamHeader)) {
+		setError(path + " is too small");
+		close();
+		return false;
+	}
+	if(!map(st.st_size, false)) {
+		close();
+		return false;
+	}
+
+	// check layout before trusting any offsets
+	DepthStreamHeader *h = header();
+	errno = 0;
+	if(std::memcmp(h->magic, DEPTHSTREAM_MAGIC, 4) != 0 || h->version != DEPTHSTREAM_VERSION) {
+		setError(path + " is not a depth stream file");
+		close();
+		return false;
+	}
+	if(h->frameSize != frameSize(h->width, h->height, h->flags & HAS_RGB) ||
+	   sizeof(DepthStreamHeader) + (std::size_t)h->frameCount * h->frameSize > mapped) {
+		setError(path + " is truncated or corrupt");
+		close();
+		return false;
+	}
+
+	// frames are read front to back
+	madvise(data, mapped, MADV_SEQUENTIAL);
+	restart();
+	return true;
+}
+
+//--------------------------------------------------------------
+void DepthPlayer::close() {
+	unmap();
+	if(fd >= 0) {
+		::close(fd);
+		fd = -1;
+	}
+	restart();
+}
+
+//--------------------------------------------------------------
+bool DepthPlayer::nextFrame() {
+	if(!isOpen() || getFrameCount() == 0) {
+		return false;
+	}
+	if(!bStarted) {
+		current = 0;
+		bStarted = true;
+		startTime = std::chrono::steady_clock::now();
+	}
+	else if(current + 1 < getFrameCount()) {
+		current++;
+	}
+	else if(bLoop) {
+		current = 0;
+		startTime = std::chrono::steady_clock::now();
+	}
+	else {
+		return false;
+	}
+	if(bRealtime) {
+		std::this_thread::sleep_until(startTime +
+			std::chrono::microseconds(getTimestamp(current) - getTimestamp(0)));
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+const std::uint16_t* DepthPlayer::getDepth(std::size_t index) const {
+	return (const std::uint16_t *)(frame(index) + sizeof(DepthFrameHeader));
+}
+
+//--------------------------------------------------------------
+const std::uint8_t* DepthPlayer::getRGB(std::size_t index) const {
+	if(!hasRGB()) {
+		return nullptr;
+	}
+	return frame(index) + sizeof(DepthFrameHeader) + depthSize();
+}
+
+//--------------------------------------------------------------
+std::uint64_t DepthPlayer::getTimestamp(std::size_t index) const {
+	return ((const DepthFrameHeader *)frame(index))->timestamp;
+}
+
+//--------------------------------------------------------------
+std::uint32_t DepthPlayer::getSequence(std::size_t index) const {
+	return ((const DepthFrameHeader *)frame(index))->sequence;
+}
+
+//--------------------------------------------------------------
+void DepthPlayer::restart() {
+	current = 0;
+	bStarted = false;
+}
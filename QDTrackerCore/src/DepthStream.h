@@ -0,0 +1,179 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <chrono>
+
+// depth stream container file (.qdt), memory mapped for reading & writing
+//
+// layout: a 64 byte file header followed by fixed size frame records, each
+// record is a 16 byte frame header, raw 16 bit depth in mm, & optional 8 bit
+// RGB, padded to 64 bytes so frame data stays aligned for vector loads
+//
+// note: uses POSIX mmap, so macOS & Linux only for now
+
+#define DEPTHSTREAM_MAGIC "QDTD"
+#define DEPTHSTREAM_VERSION 1
+
+struct DepthStreamHeader {
+	char magic[4];               // DEPTHSTREAM_MAGIC
+	std::uint32_t version;       // DEPTHSTREAM_VERSION
+	std::uint32_t width;         // depth frame width
+	std::uint32_t height;        // depth frame height
+	std::uint32_t flags;         // DepthStream::Flags
+	std::uint32_t frameCount;    // number of frame records
+	std::uint32_t frameSize;     // size of a frame record in bytes
+	float zeroPlanePixelSize;    // kinect intrinsics for world coordinates
+	float zeroPlaneDistance;
+	std::uint8_t reserved[28];
+};
+
+struct DepthFrameHeader {
+	std::uint64_t timestamp;     // capture time in us since the first frame
+	std::uint32_t sequence;      // capture sequence number
+	std::uint32_t reserved;
+};
+
+// shared mapping & layout details
+class DepthStream {
+
+	public:
+
+		enum Flags {
+			HAS_RGB = 0x1 // frames contain an RGB image after the depth
+		};
+
+		DepthStream() {}
+		virtual ~DepthStream() {}
+
+		bool isOpen() const {return data != nullptr;}
+		std::size_t getWidth() const {return header()->width;}
+		std::size_t getHeight() const {return header()->height;}
+		bool hasRGB() const {return header()->flags & HAS_RGB;}
+		std::size_t getFrameCount() const {return header()->frameCount;}
+		float getZeroPlanePixelSize() const {return header()->zeroPlanePixelSize;}
+		float getZeroPlaneDistance() const {return header()->zeroPlaneDistance;}
+
+		// last error message when open or add fails
+		const std::string& getError() const {return error;}
+
+		// record size for the given frame size, padded to 64 bytes
+		static std::size_t frameSize(std::size_t width, std::size_t height, bool rgb);
+
+	protected:
+
+		DepthStreamHeader* header() const {return (DepthStreamHeader*)data;}
+		std::uint8_t* frame(std::size_t index) const {
+			return data + sizeof(DepthStreamHeader) + index * header()->frameSize;
+		}
+		std::size_t depthSize() const {return getWidth() * getHeight() * sizeof(std::uint16_t);}
+
+		// map the first size bytes of the open file, returns false on error
+		bool map(std::size_t size, bool writable);
+		void unmap();
+		void setError(const std::string &message);
+
+		int fd = -1;                  // file descriptor
+		std::uint8_t *data = nullptr; // mapped file
+		std::size_t mapped = 0;       // mapped size in bytes
+		std::string error;
+};
+
+// writes frames into a mapped file, growing it in chunks as needed
+class DepthRecorder : public DepthStream {
+
+	public:
+
+		~DepthRecorder();
+
+		// create a new file, overwrites any existing file
+		bool open(const std::string &path, std::size_t width, std::size_t height,
+		          bool rgb, float zeroPlanePixelSize=0, float zeroPlaneDistance=0);
+
+		// finish writing & trim the file to the recorded frames
+		void close();
+
+		// append a frame, rgb is ignored when not recording RGB
+		// timestamp is the capture time in us from any monotonic clock &
+		// sequence the capture sequence number, so replay sees missed frames
+		bool addFrame(const std::uint16_t *depth, const std::uint8_t *rgb,
+		              std::uint64_t timestamp, std::uint32_t sequence);
+
+		const std::string& getPath() const {return path;}
+
+	protected:
+
+		bool grow(std::size_t frames); // extend the file to fit more frames
+
+		std::string path;
+		std::size_t capacity = 0;   // frame records the file can fit
+		std::uint64_t startTime = 0; // timestamp of the first frame
+};
+
+// reads frames straight from a read-only mapped file, no copies
+class DepthPlayer : public DepthStream {
+
+	public:
+
+		~DepthPlayer();
+
+		bool open(const std::string &path);
+		void close();
+
+		// advance to the next frame, waiting to keep the recorded pace when
+		// realtime, returns false at the end of the stream when not looping
+		bool nextFrame();
+
+		// play at the recorded pace or as fast as possible?
+		void setRealtime(bool realtime) {bRealtime = realtime; restart();}
+		bool getRealtime() const {return bRealtime;}
+
+		// start over at the end of the stream?
+		void setLoop(bool loop) {bLoop = loop;}
+		bool getLoop() const {return bLoop;}
+
+		// current frame, valid after the first nextFrame()
+		std::size_t getCurrentFrame() const {return current;}
+		const std::uint16_t* getDepth() const {return getDepth(current);}
+		const std::uint8_t* getRGB() const {return getRGB(current);}
+		std::uint64_t getTimestamp() const {return getTimestamp(current);}
+		std::uint32_t getSequence() const {return getSequence(current);}
+
+		// random access
+		const std::uint16_t* getDepth(std::size_t index) const;
+		const std::uint8_t* getRGB(std::size_t index) const; // nullptr if no RGB
+		std::uint64_t getTimestamp(std::size_t index) const;
+		std::uint32_t getSequence(std::size_t index) const;
+
+	protected:
+
+		void restart(); // reset playback to before the first frame
+
+		bool bRealtime = true;
+		bool bLoop = false;
+		std::size_t current = 0;
+		bool bStarted = false;
+		std::chrono::steady_clock::time_point startTime; // playback start
+};
@@ -0,0 +1,69 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "BlobLabeller.h"
+
+// a position in image coordinates with depth in mm, or in output units
+struct Position {
+	float x = 0, y = 0, z = 0;
+};
+
+// a raw depth frame to track, straight from the kinect or a recording
+struct DepthFrame {
+	const std::uint16_t *raw = nullptr;  // raw depth in mm, 0 is unknown
+	std::size_t rawStride = 0;           // in pixels
+	std::size_t width = 0, height = 0;
+
+	// raw depth in mm at a pixel, clamped to the frame
+	float rawAt(int x, int y) const {
+		x = (x < 0 ? 0 : (x >= (int)width ? (int)width-1 : x));
+		y = (y < 0 ? 0 : (y >= (int)height ? (int)height-1 : y));
+		return raw[y * rawStride + x];
+	}
+};
+
+// estimates a person's position from their blob: the one step that differs
+// between trackers, plugged into the TrackerCore pipeline
+class Estimator {
+
+	public:
+
+		virtual ~Estimator() {}
+
+		// name for the osc address & latency stage, ie. "head"
+		virtual const char* getName() const = 0;
+
+		// labeller options: find the nearest pixel in each blob? & the top
+		// pixel within +- this band around the centroid, 0 for none
+		virtual bool getNeedsNearest() const {return false;}
+		virtual int getTopBand() const {return 0;}
+
+		// position in image coordinates with raw depth z in mm
+		virtual Position estimate(const Blob &blob, const DepthFrame &frame) const = 0;
+
+		// copy with the same settings, ie. for another thread
+		virtual Estimator* clone() const = 0;
+};
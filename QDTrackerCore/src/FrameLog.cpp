@@ -0,0 +1,81 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "FrameLog.h"
+
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+//--------------------------------------------------------------
+FrameLog::FrameLog(std::size_t size) : entries(size > 0 ? size : 1) {}
+
+//--------------------------------------------------------------
+void FrameLog::add(const Entry &entry) {
+	entries[next] = entry;
+	next = (next + 1) % entries.size();
+	if(count < entries.size()) {
+		count++;
+	}
+}
+
+//--------------------------------------------------------------
+const FrameLog::Entry& FrameLog::operator[](std::size_t index) const {
+	return entries[(next + entries.size() - count + index) % entries.size()];
+}
+
+//--------------------------------------------------------------
+void FrameLog::clear() {
+	next = 0;
+	count = 0;
+}
+
+//--------------------------------------------------------------
+bool FrameLog::save(const std::string &path) {
+	FILE *file = std::fopen(path.c_str(), "w");
+	if(!file) {
+		error = "couldn't open " + path + ": " + std::strerror(errno);
+		return false;
+	}
+	std::fprintf(file, "sequence,capture_us,send_us,latency_ms,dropped\n");
+	for(std::size_t i = 0; i < count; ++i) {
+		const Entry &entry = (*this)[i];
+		std::fprintf(file, "%llu,%llu,%llu,%.3f,%llu\n",
+		             (unsigned long long)entry.sequence,
+		             (unsigned long long)entry.captureTime,
+		             (unsigned long long)entry.sendTime,
+		             (entry.sendTime - entry.captureTime) / 1000.0,
+		             (unsigned long long)entry.dropped);
+	}
+	if(std::fclose(file) != 0) {
+		error = "couldn't write " + path + ": " + std::strerror(errno);
+		return false;
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+std::uint64_t FrameLog::now() {
+	// steady clock is CLOCK_MONOTONIC & friends, the same for every process
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,72 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// ring log of the most recently sent frames: capture sequence number & time,
+// send time, & dropped frame count, saved as CSV on request
+//
+// times are in us from a monotonic clock shared by all processes on the same
+// machine, see now(), so local receivers can measure the end to end latency
+// from a frame's capture time
+class FrameLog {
+
+	public:
+
+		struct Entry {
+			std::uint64_t sequence = 0;    // capture sequence number
+			std::uint64_t captureTime = 0; // capture time in us
+			std::uint64_t sendTime = 0;    // send time in us
+			std::uint64_t dropped = 0;     // total frames dropped so far
+		};
+
+		FrameLog(std::size_t size=1024);
+
+		// add an entry, replacing the oldest when full
+		void add(const Entry &entry);
+
+		// number of entries & entry by index, oldest first
+		std::size_t size() const {return count;}
+		const Entry& operator[](std::size_t index) const;
+
+		void clear();
+
+		// save as CSV: sequence, capture & send time in us, capture to send
+		// latency in ms, & dropped frames, returns false on error
+		bool save(const std::string &path);
+
+		const std::string& getError() const {return error;}
+
+		// current monotonic time in us, shared by all processes on this machine
+		static std::uint64_t now();
+
+	private:
+
+		std::vector<Entry> entries; // ring buffer
+		std::size_t next = 0;       // next ring buffer index
+		std::size_t count = 0;      // number of entries in the ring
+		std::string error;
+};
@@ -0,0 +1,50 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "HeadEstimator.h"
+
+//--------------------------------------------------------------
+Position HeadEstimator::estimate(const Blob &blob, const DepthFrame &frame) const {
+	Position highest = highestPoint(blob);
+
+	// compute rough head position between centroid and highest point
+	Position head;
+	head.x = blob.centroidX*(1-headInterpolation) + highest.x*headInterpolation;
+	head.y = blob.centroidY*(1-headInterpolation) + highest.y*headInterpolation;
+	head.z = frame.rawAt(head.x, head.y);
+	return head;
+}
+
+//--------------------------------------------------------------
+Position HeadEstimator::highestPoint(const Blob &blob) {
+	// actually the lowest value since top is 0, found by the labeller within
+	// the highest point threshold band
+	Position highest;
+	if(blob.topY >= 0) {
+		highest.x = blob.topX;
+		highest.y = blob.topY;
+	}
+	else {
+		highest.x = blob.centroidX;
+		highest.y = blob.centroidY;
+	}
+	return highest;
+}
@@ -0,0 +1,42 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include "Estimator.h"
+
+// front facing head approximation: interpolates between the person centroid
+// & the highest point in the blob near the centroid
+class HeadEstimator : public Estimator {
+
+	public:
+
+		unsigned int highestPointThreshold = 50; // only consider highest points +- this & the person centroid
+		float headInterpolation = 0.6; // percentage to interpolate between person centroid & highest point (0-1)
+
+		const char* getName() const {return "head";}
+		int getTopBand() const {return highestPointThreshold;}
+		Position estimate(const Blob &blob, const DepthFrame &frame) const;
+		Estimator* clone() const {return new HeadEstimator(*this);}
+
+		// highest blob point found by the labeller, the centroid if none
+		static Position highestPoint(const Blob &blob);
+};
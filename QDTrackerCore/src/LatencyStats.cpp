@@ -0,0 +1,129 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "LatencyStats.h"
+
+#include <algorithm>
+#include <cmath>
+
+// RollingHistogram
+
+//--------------------------------------------------------------
+static std::size_t binFor(float ms) {
+	if(ms <= 0) {
+		return 0;
+	}
+	return std::min((std::size_t)(ms / RollingHistogram::BIN_MS), RollingHistogram::BINS-1);
+}
+
+//--------------------------------------------------------------
+RollingHistogram::RollingHistogram(std::size_t window) :
+	bins(BINS, 0), samples(std::max(window, (std::size_t)1), 0) {}
+
+//--------------------------------------------------------------
+void RollingHistogram::add(float ms) {
+	if(count == samples.size()) {
+		bins[binFor(samples[next])]--;
+	}
+	else {
+		count++;
+	}
+	samples[next] = ms;
+	bins[binFor(ms)]++;
+	next = (next + 1) % samples.size();
+}
+
+//--------------------------------------------------------------
+float RollingHistogram::percentile(float p) const {
+	if(count == 0) {
+		return 0;
+	}
+	std::size_t rank = std::max((std::size_t)std::ceil(p * count), (std::size_t)1);
+	std::size_t seen = 0;
+	for(std::size_t i = 0; i < BINS; ++i) {
+		seen += bins[i];
+		if(seen >= rank) {
+			// upper bin edge, not past the longest sample in the bin
+			return std::min((i + 1) * BIN_MS, max());
+		}
+	}
+	return max();
+}
+
+//--------------------------------------------------------------
+float RollingHistogram::max() const {
+	float longest = 0;
+	for(std::size_t i = 0; i < count; ++i) {
+		longest = std::max(longest, samples[i]);
+	}
+	return longest;
+}
+
+//--------------------------------------------------------------
+void RollingHistogram::clear() {
+	std::fill(bins.begin(), bins.end(), 0);
+	next = 0;
+	count = 0;
+}
+
+// LatencyStats
+
+//--------------------------------------------------------------
+void LatencyStats::setup(const std::vector<std::string> &names, std::size_t window) {
+	this->names = names;
+	this->names.push_back("total");
+	stages.assign(this->names.size(), RollingHistogram(window));
+}
+
+//--------------------------------------------------------------
+void LatencyStats::startFrame() {
+	frameStart = clock::now();
+	lapStart = frameStart;
+}
+
+//--------------------------------------------------------------
+void LatencyStats::lap(std::size_t stage) {
+	clock::time_point now = clock::now();
+	if(stage < stages.size()) {
+		stages[stage].add(std::chrono::duration<float, std::milli>(now - lapStart).count());
+	}
+	lapStart = now;
+}
+
+//--------------------------------------------------------------
+void LatencyStats::endFrame() {
+	if(stages.empty()) {
+		return;
+	}
+	clock::time_point now = clock::now();
+	stages.back().add(std::chrono::duration<float, std::milli>(now - frameStart).count());
+}
+
+//--------------------------------------------------------------
+void LatencyStats::summarize(std::vector<Summary> &summaries) const {
+	summaries.resize(stages.size());
+	for(std::size_t i = 0; i < stages.size(); ++i) {
+		summaries[i].p50 = stages[i].percentile(0.50f);
+		summaries[i].p95 = stages[i].percentile(0.95f);
+		summaries[i].p99 = stages[i].percentile(0.99f);
+		summaries[i].max = stages[i].max();
+	}
+}
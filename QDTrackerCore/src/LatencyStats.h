@@ -0,0 +1,100 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <chrono>
+
+// histogram of the last N latency samples in ms with 10 us bins up to 100 ms,
+// adding a sample is constant time & nothing is allocated after construction
+class RollingHistogram {
+
+	public:
+
+		static const std::size_t BINS = 10000; // last bin catches anything longer
+		static constexpr float BIN_MS = 0.01f; // bin width in ms
+
+		RollingHistogram(std::size_t window=300);
+
+		// add a sample, replacing the oldest when the window is full
+		void add(float ms);
+
+		// latency in ms at percentile p (0-1), the upper edge of its bin up to
+		// the longest latency, 0 if empty
+		float percentile(float p) const;
+
+		// longest latency in ms in the window, 0 if empty
+		float max() const;
+
+		// number of samples in the window
+		std::size_t size() const {return count;}
+
+		void clear();
+
+	private:
+
+		std::vector<std::uint32_t> bins; // sample count per bin, fits any window
+		std::vector<float> samples;      // sample ring buffer
+		std::size_t next = 0;            // next ring buffer index
+		std::size_t count = 0;           // number of samples in the ring
+};
+
+// per-stage pipeline latency: call startFrame(), then lap() after each stage
+class LatencyStats {
+
+	public:
+
+		struct Summary {
+			float p50 = 0, p95 = 0, p99 = 0, max = 0; // in ms
+		};
+
+		// set the stage names, a "total" stage for the whole frame is added
+		// last, window is the number of frames to keep
+		void setup(const std::vector<std::string> &names, std::size_t window=300);
+
+		// start timing a frame
+		void startFrame();
+
+		// time since the previous lap or frame start goes to the given stage
+		void lap(std::size_t stage);
+
+		// time since frame start goes to the total stage
+		void endFrame();
+
+		// summarize all stages, in stage order with total last
+		void summarize(std::vector<Summary> &summaries) const;
+
+		// number of stages including total
+		std::size_t size() const {return stages.size();}
+		const std::string& getName(std::size_t stage) const {return names[stage];}
+
+	private:
+
+		typedef std::chrono::steady_clock clock;
+
+		std::vector<std::string> names;
+		std::vector<RollingHistogram> stages;
+		clock::time_point frameStart, lapStart;
+};
@@ -0,0 +1,68 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "OneEuroFilter.h"
+
+#include <cmath>
+
+//--------------------------------------------------------------
+void OneEuroFilter::setup(float minCutoff, float beta, float derivativeCutoff) {
+	this->minCutoff = minCutoff;
+	this->beta = beta;
+	this->derivativeCutoff = derivativeCutoff;
+}
+
+//--------------------------------------------------------------
+float OneEuroFilter::filter(float value, double time) {
+	float dt = time - lastTime;
+	if(bFirst || dt <= 0) {
+		if(bFirst) {
+			this->value = lastValue = value;
+			velocity = 0;
+			bFirst = false;
+		}
+		lastTime = time;
+		return this->value;
+	}
+	lastTime = time;
+
+	// smooth the speed, then use it to pick the value cutoff: the speed is
+	// taken from the unfiltered values so it doesn't include the filter lag
+	float speed = (value - lastValue) / dt;
+	lastValue = value;
+	velocity += alpha(derivativeCutoff, dt) * (speed - velocity);
+	float cutoff = minCutoff + beta * std::fabs(velocity);
+	this->value += alpha(cutoff, dt) * (value - this->value);
+	return this->value;
+}
+
+//--------------------------------------------------------------
+void OneEuroFilter::reset() {
+	value = lastValue = velocity = 0;
+	lastTime = 0;
+	bFirst = true;
+}
+
+//--------------------------------------------------------------
+float OneEuroFilter::alpha(float cutoff, float dt) {
+	float tau = 1.0 / (2 * M_PI * cutoff);
+	return 1.0 / (1.0 + tau / dt);
+}
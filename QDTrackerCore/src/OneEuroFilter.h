@@ -0,0 +1,61 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+// One Euro filter: an adaptive low pass filter for noisy positions, see
+// Casiez, Roussel & Vogel, "1 Euro Filter", CHI 2012
+//
+// the cutoff frequency rises with speed, so slow movements are smoothed
+// heavily & fast ones follow closely without much lag, the filtered speed is
+// also kept for extrapolation
+class OneEuroFilter {
+
+	public:
+
+		// minCutoff: cutoff frequency in Hz when still, lower is smoother
+		// beta: how much the cutoff rises with speed, higher is less lag
+		// derivativeCutoff: cutoff frequency in Hz for the speed
+		void setup(float minCutoff=1, float beta=0, float derivativeCutoff=1);
+
+		// filter a new value at a time in seconds, returns the filtered value
+		float filter(float value, double time);
+
+		// last filtered value
+		float getValue() const {return value;}
+
+		// last filtered speed in units per second
+		float getVelocity() const {return velocity;}
+
+		// forget the previous values, the next value passes through as is
+		void reset();
+
+	private:
+
+		// smoothing factor for a cutoff frequency & time step
+		static float alpha(float cutoff, float dt);
+
+		float minCutoff = 1, beta = 0, derivativeCutoff = 1;
+		float value = 0, velocity = 0;
+		float lastValue = 0; // last unfiltered value
+		double lastTime = 0;
+		bool bFirst = true;
+};
@@ -0,0 +1,150 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "OscPacket.h"
+
+#include <cstring>
+
+//--------------------------------------------------------------
+void OscPacket::begin(const char *address, const char *types) {
+	if(bBundle) {
+		// bundle elements are prefixed by their size, set when they end
+		endElement();
+		if(bOverflow) {
+			return; // full
+		}
+		element = size;
+		add32(0);
+	}
+	else {
+		size = 0;
+		numMessages = 0;
+		bOverflow = false;
+	}
+	numMessages++;
+	pad(address, std::strlen(address) + 1);
+
+	// type tags start with a comma
+	std::size_t count = std::strlen(types) + 2;
+	std::size_t padded = (count + 3) & ~(std::size_t)3;
+	if(bOverflow || size + padded > OSCPACKET_SIZE) {
+		bOverflow = true;
+		return;
+	}
+	data[size] = ',';
+	std::memcpy(data + size + 1, types, count - 1);
+	std::memset(data + size + count, 0, padded - count);
+	size += padded;
+}
+
+//--------------------------------------------------------------
+void OscPacket::beginBundle(std::uint64_t timetag) {
+	size = 0;
+	numMessages = 0;
+	bOverflow = false;
+	bBundle = true;
+	element = 0;
+	pad("#bundle", 8);
+	add32((std::uint32_t)(timetag >> 32));
+	add32((std::uint32_t)timetag);
+}
+
+//--------------------------------------------------------------
+void OscPacket::endBundle() {
+	endElement();
+	bBundle = false;
+}
+
+//--------------------------------------------------------------
+std::uint64_t OscPacket::timetag(std::uint64_t micros) {
+	// seconds since 1900 & 32 bit fraction
+	const std::uint64_t EPOCH_OFFSET = 2208988800ULL; // 1900 -> 1970 in seconds
+	std::uint64_t seconds = micros / 1000000 + EPOCH_OFFSET;
+	std::uint64_t fraction = ((micros % 1000000) << 32) / 1000000;
+	return (seconds << 32) | fraction;
+}
+
+//--------------------------------------------------------------
+void OscPacket::addInt(std::int32_t value) {
+	add32((std::uint32_t)value);
+}
+
+//--------------------------------------------------------------
+void OscPacket::addInt64(std::int64_t value) {
+	add32((std::uint32_t)((std::uint64_t)value >> 32));
+	add32((std::uint32_t)value);
+}
+
+//--------------------------------------------------------------
+void OscPacket::addFloat(float value) {
+	std::uint32_t bits;
+	std::memcpy(&bits, &value, 4);
+	add32(bits);
+}
+
+//--------------------------------------------------------------
+void OscPacket::addString(const char *value) {
+	pad(value, std::strlen(value) + 1);
+}
+
+//--------------------------------------------------------------
+void OscPacket::endElement() {
+	if(element == 0) {
+		return;
+	}
+	if(bOverflow) {
+		// drop the partial message, the bundle up to it is still valid
+		size = element;
+		numMessages--;
+	}
+	else {
+		std::uint32_t length = (std::uint32_t)(size - element - 4);
+		data[element] = (char)(length >> 24);
+		data[element + 1] = (char)(length >> 16);
+		data[element + 2] = (char)(length >> 8);
+		data[element + 3] = (char)length;
+	}
+	element = 0;
+}
+
+//--------------------------------------------------------------
+void OscPacket::pad(const char *bytes, std::size_t count) {
+	std::size_t padded = (count + 3) & ~(std::size_t)3;
+	if(bOverflow || size + padded > OSCPACKET_SIZE) {
+		bOverflow = true;
+		return;
+	}
+	std::memcpy(data + size, bytes, count);
+	std::memset(data + size + count, 0, padded - count);
+	size += padded;
+}
+
+//--------------------------------------------------------------
+void OscPacket::add32(std::uint32_t value) {
+	if(bOverflow || size + 4 > OSCPACKET_SIZE) {
+		bOverflow = true;
+		return;
+	}
+	data[size++] = (char)(value >> 24);
+	data[size++] = (char)(value >> 16);
+	data[size++] = (char)(value >> 8);
+	data[size++] = (char)value;
+}
@@ -0,0 +1,90 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#define OSCPACKET_SIZE 8192 // max encoded packet size in bytes, ie. a frame's bundle
+
+// OSC message encoder writing into a fixed size buffer, so sending never
+// allocates: begin a message with its address & type tags, then add the
+// arguments in the same order
+//
+//     packet.begin("/head", "ifff");
+//     packet.addInt(id);
+//     packet.addFloat(x);
+//     ...
+//     sender.send(packet.getData(), packet.getSize());
+//
+// messages begun between beginBundle() & endBundle() are packed into a single
+// bundle instead, messages which don't fit are dropped
+//
+// only the int32 (i), int64 (h), float32 (f), & string (s) types are supported
+class OscPacket {
+
+	public:
+
+		// start a new message, clearing the last one unless bundling
+		void begin(const char *address, const char *types);
+
+		// start a new bundle with an NTP timetag, clearing the last packet
+		void beginBundle(std::uint64_t timetag);
+
+		// finish the bundle, call before sending
+		void endBundle();
+
+		// NTP timetag from a time in us since the unix epoch
+		static std::uint64_t timetag(std::uint64_t micros);
+
+		void addInt(std::int32_t value);
+		void addInt64(std::int64_t value);
+		void addFloat(float value);
+		void addString(const char *value);
+
+		// encoded packet, check isOk() before sending
+		const char* getData() const {return data;}
+		std::size_t getSize() const {return size;}
+
+		// false if the packet didn't fit in the buffer
+		bool isOk() const {return !bOverflow;}
+
+		// number of messages in the packet, more than 1 when bundling
+		std::size_t getNumMessages() const {return numMessages;}
+
+	private:
+
+		// set the size of the current bundle element or drop it if it
+		// didn't fit
+		void endElement();
+
+		// append bytes, padded with 0s to a multiple of 4
+		void pad(const char *bytes, std::size_t count);
+		void add32(std::uint32_t value); // big endian
+
+		char data[OSCPACKET_SIZE];
+		std::size_t size = 0;
+		std::size_t numMessages = 0;
+		bool bOverflow = false;
+		bool bBundle = false; // bundling?
+		std::size_t element = 0; // start of the current bundle element, 0 if none
+};
@@ -0,0 +1,39 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "OverheadEstimator.h"
+
+//--------------------------------------------------------------
+Position OverheadEstimator::estimate(const Blob &blob, const DepthFrame &frame) const {
+	// closest point in the person blob & its depth, found by the labeller
+	Position overhead;
+	if(blob.nearestY >= 0) {
+		overhead.x = blob.nearestX;
+		overhead.y = blob.nearestY;
+		overhead.z = blob.nearestDepth;
+	}
+	else {
+		overhead.x = blob.centroidX;
+		overhead.y = blob.centroidY;
+		overhead.z = frame.rawAt(overhead.x, overhead.y);
+	}
+	return overhead;
+}
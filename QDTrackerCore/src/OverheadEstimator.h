@@ -0,0 +1,36 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include "Estimator.h"
+
+// overhead head position: the closest point in the blob to an overhead
+// kinect, aka the brightest depth pixel
+class OverheadEstimator : public Estimator {
+
+	public:
+
+		const char* getName() const {return "overhead";}
+		bool getNeedsNearest() const {return true;}
+		Position estimate(const Blob &blob, const DepthFrame &frame) const;
+		Estimator* clone() const {return new OverheadEstimator(*this);}
+};
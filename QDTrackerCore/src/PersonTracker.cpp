@@ -0,0 +1,142 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "PersonTracker.h"
+
+#include <algorithm>
+
+//--------------------------------------------------------------
+void PersonTracker::setup(std::size_t maxTracks) {
+	this->maxTracks = maxTracks;
+	tracks.clear();
+	tracks.reserve(maxTracks);
+	events.clear();
+	events.reserve(maxTracks * 2);
+	pairs.reserve(maxTracks * maxTracks);
+	ids.assign(maxTracks, 0);
+	matched.assign(maxTracks, false);
+}
+
+//--------------------------------------------------------------
+void PersonTracker::update(const Detection *detections, std::size_t count) {
+	events.clear();
+	count = std::min(count, maxTracks);
+
+	// drop everything?
+	if(bClear) {
+		for(std::size_t i = 0; i < tracks.size(); ++i) {
+			events.push_back({LEAVE, tracks[i].id});
+		}
+		tracks.clear();
+		bClear = false;
+	}
+
+	// candidate pairs within range of the predicted positions, closest first
+	pairs.clear();
+	float maxDistance2 = maxDistance * maxDistance;
+	for(std::size_t t = 0; t < tracks.size(); ++t) {
+		tracks[t].detection = -1;
+		float px = tracks[t].predictX();
+		float py = tracks[t].predictY();
+		for(std::size_t d = 0; d < count; ++d) {
+			float dx = detections[d].x - px;
+			float dy = detections[d].y - py;
+			float distance = dx*dx + dy*dy;
+			if(distance <= maxDistance2) {
+				pairs.push_back({distance, t, d});
+			}
+		}
+	}
+	std::sort(pairs.begin(), pairs.end());
+
+	// greedy match
+	std::fill(ids.begin(), ids.end(), 0);
+	std::fill(matched.begin(), matched.end(), false);
+	for(std::size_t i = 0; i < pairs.size(); ++i) {
+		Track &track = tracks[pairs[i].track];
+		std::size_t d = pairs[i].detection;
+		if(track.detection >= 0 || matched[d]) {
+			continue;
+		}
+		// smooth the velocity a little, single frame jitter is common
+		const Detection &detection = detections[d];
+		track.detection = d;
+		track.vx = (track.vx + detection.x - track.x) * 0.5f;
+		track.vy = (track.vy + detection.y - track.y) * 0.5f;
+		track.x = detection.x;
+		track.y = detection.y;
+		track.width = detection.width;
+		track.height = detection.height;
+		track.missed = 0;
+		ids[d] = track.id;
+		matched[d] = true;
+	}
+
+	// coast unmatched tracks & drop those missing for too long
+	for(std::size_t t = 0; t < tracks.size();) {
+		Track &track = tracks[t];
+		if(track.detection >= 0) {
+			t++;
+			continue;
+		}
+		if(++track.missed > maxMissed) {
+			events.push_back({LEAVE, track.id});
+			tracks[t] = tracks.back();
+			tracks.pop_back();
+			continue;
+		}
+		track.x += track.vx;
+		track.y += track.vy;
+		t++;
+	}
+
+	// start new tracks for unmatched detections
+	for(std::size_t d = 0; d < count; ++d) {
+		if(matched[d] || tracks.size() >= maxTracks) {
+			continue;
+		}
+		Track track;
+		track.id = nextId++;
+		track.x = detections[d].x;
+		track.y = detections[d].y;
+		track.vx = track.vy = 0;
+		track.width = detections[d].width;
+		track.height = detections[d].height;
+		track.missed = 0;
+		track.detection = d;
+		tracks.push_back(track);
+		events.push_back({ENTER, track.id});
+		ids[d] = track.id;
+	}
+}
+
+//--------------------------------------------------------------
+unsigned int PersonTracker::getId(std::size_t detection) const {
+	if(detection >= ids.size()) {
+		return 0;
+	}
+	return ids[detection];
+}
+
+//--------------------------------------------------------------
+void PersonTracker::clear() {
+	bClear = true;
+}
@@ -0,0 +1,114 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// matches per-frame person detections to tracks with persistent ids
+//
+// greedy nearest neighbour association: all track/detection pairs within the
+// max distance are matched closest first, unmatched detections start new
+// tracks & tracks without a detection for too many frames are dropped
+//
+// tracks follow a constant velocity model, so matching is done against the
+// predicted position & missed tracks coast along their last velocity
+//
+// all storage is sized by setup(), so update() never allocates
+class PersonTracker {
+
+	public:
+
+		enum EventType {
+			ENTER, // new track
+			LEAVE  // track dropped
+		};
+
+		struct Event {
+			EventType type;
+			unsigned int id;
+		};
+
+		struct Detection {
+			float x, y;          // center position
+			float width, height; // size
+		};
+
+		struct Track {
+			unsigned int id;     // persistent id, starting at 1
+			float x, y;          // current position
+			float vx, vy;        // velocity per frame
+			float width, height; // last matched size
+			unsigned int missed; // consecutive frames without a detection
+			int detection;       // matched detection this frame, -1 if none
+
+			// predicted position in the next frame
+			float predictX() const {return x + vx;}
+			float predictY() const {return y + vy;}
+		};
+
+		// allocate for up to maxTracks tracks & detections per frame
+		void setup(std::size_t maxTracks);
+
+		// max distance between a track & its detection in the next frame
+		void setMaxDistance(float distance) {maxDistance = distance;}
+		float getMaxDistance() const {return maxDistance;}
+
+		// number of frames a track is kept without a detection
+		void setMaxMissed(unsigned int frames) {maxMissed = frames;}
+		unsigned int getMaxMissed() const {return maxMissed;}
+
+		// match this frame's detections to tracks
+		void update(const Detection *detections, std::size_t count);
+
+		// track id for a detection after update(), 0 if not tracked
+		unsigned int getId(std::size_t detection) const;
+
+		// current tracks, including ones missed this frame
+		const std::vector<Track>& getTracks() const {return tracks;}
+
+		// enter & leave events from the last update()
+		const std::vector<Event>& getEvents() const {return events;}
+
+		// drop all tracks, sending leave events on the next update()
+		void clear();
+
+	private:
+
+		struct Pair {
+			float distance; // squared
+			std::size_t track, detection;
+			bool operator<(const Pair &other) const {return distance < other.distance;}
+		};
+
+		std::size_t maxTracks = 0;
+		float maxDistance = 100;
+		unsigned int maxMissed = 10;
+		unsigned int nextId = 1;
+		bool bClear = false;
+
+		std::vector<Track> tracks;
+		std::vector<Event> events;
+		std::vector<Pair> pairs;
+		std::vector<unsigned int> ids;        // track id per detection
+		std::vector<bool> matched;            // detection matched this frame?
+};
@@ -0,0 +1,140 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "Sensor.h"
+
+//--------------------------------------------------------------
+bool Sensor::setup(unsigned int kinectID, std::size_t maxPersons,
+                   const Estimator *const *estimators, std::size_t numEstimators,
+                   const Settings &settings) {
+	this->kinectID = kinectID;
+	this->settings = settings;
+	kinect.init(false, false, false); // no IR image, no video, no textures
+	kinect.setRegistration(true);
+	kinect.setDepthClipping(settings.nearClipping, settings.farClipping);
+	if(!kinect.open(kinectID)) {
+		return false;
+	}
+	tracker.setup(kinect.width, kinect.height, maxPersons);
+	tracker.getRays().setup(kinect.width, kinect.height,
+	                        kinect.getZeroPlanePixelSize(), kinect.getZeroPlaneDistance());
+	tracker.setSettings(settings.tracking);
+	tracker.resetBackground(); // learned at startup, not saved
+	setEstimators(estimators, numEstimators);
+	startThread();
+	return true;
+}
+
+//--------------------------------------------------------------
+void Sensor::close() {
+	waitForThread(true);
+	kinect.close();
+}
+
+//--------------------------------------------------------------
+void Sensor::setSettings(const Settings &settings) {
+	// the worker holds the mutex for a whole frame, so don't wait on it
+	newSettings.back() = settings;
+	newSettings.publish();
+}
+
+//--------------------------------------------------------------
+void Sensor::setEstimators(const Estimator *const *estimators, std::size_t count) {
+	std::unique_lock<std::mutex> lock(mutex);
+	std::vector<const Estimator*> copies;
+	this->estimators.clear();
+	for(std::size_t i = 0; i < count; ++i) {
+		this->estimators.emplace_back(estimators[i]->clone());
+		copies.push_back(this->estimators.back().get());
+	}
+	tracker.setEstimators(copies.data(), copies.size());
+}
+
+//--------------------------------------------------------------
+void Sensor::resetBackground() {
+	std::unique_lock<std::mutex> lock(mutex);
+	tracker.resetBackground();
+}
+
+//--------------------------------------------------------------
+const Sensor::Frame& Sensor::getFrame() {
+	frames.update();
+	return frames.front();
+}
+
+//--------------------------------------------------------------
+void Sensor::threadedFunction() {
+	while(isThreadRunning()) {
+		kinect.update();
+		if(!kinect.isFrameNewDepth()) {
+			sleep(1);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(mutex);
+		processFrame();
+	}
+}
+
+//--------------------------------------------------------------
+void Sensor::processFrame() {
+	updateSettings();
+	Frame &frame = frames.back();
+	frame.time = ofGetElapsedTimeMicros();
+	frame.positions.clear();
+
+	// find persons, same as the app
+	DepthFrame depth;
+	depth.raw = kinect.getRawDepthPixels().getData();
+	depth.rawStride = kinect.width;
+	depth.width = kinect.width;
+	depth.height = kinect.height;
+	tracker.process(depth);
+
+	// estimated positions into world coordinates, skipping persons without
+	// depth at the primary estimate
+	std::size_t numEstimators = tracker.getNumEstimators();
+	for(std::size_t i = 0; i < tracker.size(); ++i) {
+		const Position *estimates = tracker[i].estimates;
+		if(tracker.getRays().unprojectAt(tracker.getFrame(), estimates[0].x, estimates[0].y).z <= 0) {
+			continue; // no depth here
+		}
+		for(std::size_t e = 0; e < numEstimators; ++e) {
+			Position camera = tracker.getRays().unprojectAt(tracker.getFrame(), estimates[e].x, estimates[e].y);
+			frame.positions.push_back(glm::vec3(settings.transform * glm::vec4(camera.x, camera.y, camera.z, 1)));
+		}
+	}
+
+	frames.publish();
+}
+
+//--------------------------------------------------------------
+void Sensor::updateSettings() {
+	if(!newSettings.update()) {
+		return;
+	}
+	const Settings &settings = newSettings.front();
+	if(settings.nearClipping != this->settings.nearClipping ||
+	   settings.farClipping != this->settings.farClipping) {
+		kinect.setDepthClipping(settings.nearClipping, settings.farClipping);
+	}
+	this->settings = settings;
+	tracker.setSettings(settings.tracking);
+}
@@ -0,0 +1,95 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include "ofMain.h"
+
+#include "ofxKinect.h"
+
+#include "TripleBuffer.h"
+#include "TrackerCore.h"
+
+// an additional kinect captured & processed on its own worker thread: finds
+// person positions in world coordinates for the app to fuse with its own
+class Sensor : public ofThread {
+
+	public:
+
+		// tracking settings, copied from the app's
+		struct Settings {
+			TrackerCore::Settings tracking;
+			unsigned int nearClipping = 500, farClipping = 4000;
+			glm::mat4 transform; // camera -> world extrinsic transform
+		};
+
+		// positions found in a frame
+		struct Frame {
+			std::uint64_t time = 0;           // frame time in us, 0 if none yet
+			std::vector<glm::vec3> positions; // world coordinates in mm, one per estimator for each person
+		};
+
+		// open a kinect & start the worker thread, returns false on error
+		// maxPersons: max number of persons the settings may ask for
+		bool setup(unsigned int kinectID, std::size_t maxPersons,
+		           const Estimator *const *estimators, std::size_t numEstimators,
+		           const Settings &settings);
+		void close();
+
+		// update the settings, picked up by the worker before its next frame
+		// note: lock-free, call from a single producer thread only
+		void setSettings(const Settings &settings);
+
+		// use copies of the estimators, ie. after their settings change
+		// note: locks the mutex
+		void setEstimators(const Estimator *const *estimators, std::size_t count);
+
+		// forget the learned background & learn it again
+		// note: locks the mutex
+		void resetBackground();
+
+		// latest frame, new or not, call from a single consumer thread only
+		const Frame& getFrame();
+
+		unsigned int getKinectID() const {return kinectID;}
+
+	protected:
+
+		// worker thread loop
+		void threadedFunction();
+
+		// find persons in the current kinect frame
+		// note: called from the worker thread with the mutex locked
+		void processFrame();
+
+		// use the latest settings handed over by setSettings(), if any
+		// note: called from the worker thread with the mutex locked
+		void updateSettings();
+
+		ofxKinect kinect;
+		unsigned int kinectID = 0;
+		Settings settings;
+		TripleBuffer<Settings> newSettings; // handed to the worker, lock-free
+
+		TrackerCore tracker;
+		std::vector<std::unique_ptr<Estimator>> estimators;
+		TripleBuffer<Frame> frames; // latest frames, lock-free
+};
@@ -0,0 +1,98 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "ShmOutput.h"
+
+#include <cerrno>
+#include <cstring>
+
+static_assert(sizeof(qdtshm_track) == 32, "qdtshm_track must be 32 bytes");
+static_assert(offsetof(qdtshm_header, ring) == 64, "qdtshm_header must be 64 bytes before the ring");
+
+//--------------------------------------------------------------
+bool ShmOutput::setup(const std::string &name, const std::string *estimators, std::size_t numEstimators) {
+	close();
+	int fd = shm_open(name.c_str(), O_CREAT|O_RDWR, 0644);
+	if(fd < 0) {
+		error = "couldn't open shared memory " + name + ": " + std::strerror(errno);
+		return false;
+	}
+	if(ftruncate(fd, sizeof(qdtshm_header)) != 0) {
+		error = "couldn't size shared memory " + name + ": " + std::strerror(errno);
+		::close(fd);
+		return false;
+	}
+	void *mem = mmap(nullptr, sizeof(qdtshm_header), PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if(mem == MAP_FAILED) {
+		error = "couldn't map shared memory " + name + ": " + std::strerror(errno);
+		return false;
+	}
+	shm = (qdtshm_header *)mem;
+
+	// keep counting from the last frame left by an earlier run, so readers
+	// still mapping it see the new frames, & keep the slot sequences even
+	frame = __atomic_load_n(&shm->head, __ATOMIC_RELAXED);
+	for(qdtshm_frame &f : shm->ring) {
+		f.sequence &= ~(std::uint64_t)1;
+	}
+	std::memcpy(shm->magic, QDTSHM_MAGIC, 4);
+	shm->version = QDTSHM_VERSION;
+	shm->ringSize = QDTSHM_RING_SIZE;
+	shm->maxTracks = QDTSHM_MAX_TRACKS;
+	shm->numEstimators = (numEstimators < QDTSHM_MAX_ESTIMATORS ? numEstimators : QDTSHM_MAX_ESTIMATORS);
+	std::memset(shm->estimators, 0, sizeof(shm->estimators));
+	for(std::size_t e = 0; e < shm->numEstimators; ++e) {
+		std::strncpy(shm->estimators[e], estimators[e].c_str(), QDTSHM_NAME_SIZE - 1);
+	}
+	error.clear();
+	return true;
+}
+
+//--------------------------------------------------------------
+void ShmOutput::close() {
+	if(shm) {
+		munmap(shm, sizeof(qdtshm_header));
+		shm = nullptr;
+		slot = nullptr;
+	}
+}
+
+//--------------------------------------------------------------
+qdtshm_frame& ShmOutput::begin() {
+	slot = &shm->ring[(frame + 1) % QDTSHM_RING_SIZE];
+	std::uint64_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+	__atomic_store_n(&slot->sequence, sequence + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE); // odd before the writes
+	return *slot;
+}
+
+//--------------------------------------------------------------
+void ShmOutput::publish(std::uint64_t timestamp) {
+	frame++;
+	slot->frame = frame;
+	slot->timestamp = timestamp;
+	if(slot->numTracks > QDTSHM_MAX_TRACKS) {
+		slot->numTracks = QDTSHM_MAX_TRACKS;
+	}
+	__atomic_store_n(&slot->sequence, slot->sequence + 1, __ATOMIC_RELEASE);
+	__atomic_store_n(&shm->head, frame, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,66 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "qdtshm.h"
+
+// shared memory output ring writer for same-host clients, see qdtshm.h for the
+// layout & the C reader: each frame is written into the next ring slot under
+// its seqlock, so writing never waits on readers & never makes a syscall
+//
+//     qdtshm_frame &frame = shm.begin();
+//     frame.numTracks = ...
+//     frame.tracks[i] = ...
+//     shm.publish(timestamp);
+//
+// note: uses POSIX shared memory, so macOS & Linux only for now
+class ShmOutput {
+
+	public:
+
+		~ShmOutput() {close();}
+
+		// create or reuse the named shared memory object, ie. "/qdtracker",
+		// with an osc address per estimator, returns false on error
+		bool setup(const std::string &name, const std::string *estimators, std::size_t numEstimators);
+		void close();
+
+		bool isOpen() const {return shm != nullptr;}
+
+		// writer: start writing the next frame, fill in the tracks & their
+		// count, then publish it with its capture time in us since the unix
+		// epoch: readers skip the frame until it's published
+		qdtshm_frame& begin();
+		void publish(std::uint64_t timestamp);
+
+		const std::string& getError() const {return error;}
+
+	private:
+
+		qdtshm_header *shm = nullptr; // mapping, nullptr if closed
+		qdtshm_frame *slot = nullptr; // frame being written
+		std::uint64_t frame = 0;      // last published frame number
+		std::string error;
+};
@@ -0,0 +1,73 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// lock-free single producer / single consumer fixed size queue
+//
+// the writer push()es & the reader pop()s, neither side ever waits on the
+// other: push() fails when the queue is full instead of waiting for room
+template<typename T, std::size_t N>
+class SpscQueue {
+
+	public:
+
+		// writer: add a value, returns false if full
+		bool push(const T &value) {
+			std::size_t h = head.load(std::memory_order_relaxed);
+			std::size_t next = (h + 1) % (N + 1);
+			if(next == tail.load(std::memory_order_acquire)) {
+				return false;
+			}
+			items[h] = value;
+			head.store(next, std::memory_order_release);
+			return true;
+		}
+
+		// reader: take the oldest value, returns false if empty
+		bool pop(T &value) {
+			std::size_t t = tail.load(std::memory_order_relaxed);
+			if(t == head.load(std::memory_order_acquire)) {
+				return false;
+			}
+			value = items[t];
+			tail.store((t + 1) % (N + 1), std::memory_order_release);
+			return true;
+		}
+
+	private:
+
+		// the indices are padded onto their own cache lines, so the writer &
+		// reader don't contend: padded instead of over-aligned, which heap
+		// allocated owners can't guarantee before C++17
+		static const std::size_t CACHE_LINE = 64;
+		typedef std::atomic<std::size_t> Index;
+
+		T items[N + 1]; // one slot is always free to tell full from empty
+		char itemsPad[CACHE_LINE];
+		Index head{0}; // next to write
+		char headPad[CACHE_LINE - sizeof(Index)];
+		Index tail{0}; // next to read
+		char tailPad[CACHE_LINE - sizeof(Index)];
+};
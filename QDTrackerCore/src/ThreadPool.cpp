@@ -0,0 +1,127 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "ThreadPool.h"
+
+//--------------------------------------------------------------
+void ThreadPool::setup(std::size_t numThreads) {
+	close();
+	if(numThreads < 2) {
+		return;
+	}
+	queueStorage.reset(new Queue[numThreads]);
+	for(std::size_t i = 0; i < numThreads; ++i) {
+		queues.push_back(&queueStorage[i]);
+	}
+	bStop = false;
+	for(std::size_t i = 1; i < numThreads; ++i) {
+		workers.emplace_back(&ThreadPool::workerFunction, this, i);
+	}
+}
+
+//--------------------------------------------------------------
+void ThreadPool::close() {
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		bStop = true;
+	}
+	startCondition.notify_all();
+	for(std::thread &worker : workers) {
+		worker.join();
+	}
+	workers.clear();
+	queues.clear();
+	queueStorage.reset();
+}
+
+//--------------------------------------------------------------
+void ThreadPool::run(std::size_t count, void (*task)(void *context, std::size_t i), void *context) {
+	if(queues.empty() || count < 2) {
+		for(std::size_t i = 0; i < count; ++i) {
+			task(context, i);
+		}
+		return;
+	}
+
+	// split the tasks into a contiguous range per thread, set before the
+	// ranges so a thread that takes a task sees this run's function
+	this->task = task;
+	this->context = context;
+	remaining = count;
+	std::size_t numThreads = queues.size();
+	for(std::size_t i = 0; i < numThreads; ++i) {
+		std::unique_lock<std::mutex> lock(queues[i]->mutex);
+		queues[i]->begin = count * i / numThreads;
+		queues[i]->end = count * (i + 1) / numThreads;
+	}
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		generation++;
+	}
+	startCondition.notify_all();
+
+	// help out, then wait for any tasks still running on the workers
+	work(0);
+	std::unique_lock<std::mutex> lock(mutex);
+	doneCondition.wait(lock, [this] {return remaining == 0;});
+}
+
+//--------------------------------------------------------------
+void ThreadPool::workerFunction(std::size_t index) {
+	std::uint64_t seen = 0;
+	while(true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			startCondition.wait(lock, [&] {return bStop || generation != seen;});
+			if(bStop) {
+				return;
+			}
+			seen = generation;
+		}
+		work(index);
+	}
+}
+
+//--------------------------------------------------------------
+void ThreadPool::work(std::size_t index) {
+	std::size_t numThreads = queues.size();
+	while(true) {
+		// own tasks from the front, then the others' from the back
+		std::size_t i = 0;
+		bool bFound = false;
+		for(std::size_t n = 0; n < numThreads && !bFound; ++n) {
+			Queue &queue = *queues[(index + n) % numThreads];
+			std::unique_lock<std::mutex> lock(queue.mutex);
+			if(queue.begin < queue.end) {
+				i = (n == 0 ? queue.begin++ : --queue.end);
+				bFound = true;
+			}
+		}
+		if(!bFound) {
+			return;
+		}
+		task(context, i);
+		if(--remaining == 0) {
+			std::unique_lock<std::mutex> lock(mutex);
+			doneCondition.notify_all();
+		}
+	}
+}
@@ -0,0 +1,93 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// small work-stealing thread pool for splitting a frame into bands
+//
+// run() hands out task indices, ie. row bands, in a contiguous range to each
+// thread, the calling thread included: a thread takes from the front of its
+// own range & steals from the back of the others' when it runs out, so the
+// bands stay in cache order & a slow band doesn't hold everyone up
+//
+// tasks are called through a plain function pointer, so running never
+// allocates
+class ThreadPool {
+
+	public:
+
+		~ThreadPool() {close();}
+
+		// start numThreads - 1 workers, the calling thread is the other one:
+		// 1 or less runs everything on the calling thread
+		void setup(std::size_t numThreads);
+		void close();
+
+		// number of threads run() uses, including the calling thread
+		std::size_t getNumThreads() const {return queues.size() > 0 ? queues.size() : 1;}
+
+		// call function(i) for each i in [0, count) across the pool & wait
+		// for them all to finish, call from a single thread only
+		template<typename Function>
+		void run(std::size_t count, Function &function) {
+			run(count, &call<Function>, &function);
+		}
+		void run(std::size_t count, void (*task)(void *context, std::size_t i), void *context);
+
+	private:
+
+		template<typename Function>
+		static void call(void *function, std::size_t i) {(*(Function *)function)(i);}
+
+		// task indices left for a thread: [begin, end)
+		struct Queue {
+			std::mutex mutex;
+			std::size_t begin = 0, end = 0;
+		};
+
+		// worker thread loop
+		void workerFunction(std::size_t index);
+
+		// run tasks from the queue at index, then steal, until none are left
+		void work(std::size_t index);
+
+		std::unique_ptr<Queue[]> queueStorage;
+		std::vector<Queue*> queues; // one per thread, the caller's first
+		std::vector<std::thread> workers;
+
+		void (*task)(void *context, std::size_t i) = nullptr;
+		void *context = nullptr;
+		std::atomic<std::size_t> remaining{0}; // tasks not finished yet
+
+		std::mutex mutex;
+		std::condition_variable startCondition, doneCondition;
+		std::uint64_t generation = 0; // incremented for each run()
+		bool bStop = false;
+};
@@ -0,0 +1,1345 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ * Largely adapted from the Kinect Titty Tracker:
+ * http://danomatika.com/projects/kinect-titty-tracker
+ *
+ */
+#include "TrackerApp.h"
+
+//--------------------------------------------------------------
+void TrackerApp::setup() {
+
+	if(bHeadless) {
+		// nothing to do on the main thread, tracking runs as fast as frames arrive
+		ofSetFrameRate(10);
+		ofLogNotice() << "running headless";
+	}
+	else {
+		ofSetVerticalSync(true);
+	}
+	positionAddresses.clear();
+	for(Estimator *estimator : estimators) {
+		positionAddresses.push_back(std::string("/") + estimator->getName());
+	}
+	
+	// settings
+	resetSettings();
+	loadSettings();
+	
+	// replay a recording?
+	if(replayFile != "") {
+		if(!player.open(ofToDataPath(replayFile))) {
+			ofLogError() << "couldn't open replay: " << player.getError();
+		}
+		else if(player.getWidth() != (std::size_t)kinect.width ||
+		        player.getHeight() != (std::size_t)kinect.height) {
+			ofLogError() << "couldn't replay " << replayFile << ": unsupported frame size "
+			             << player.getWidth() << "x" << player.getHeight();
+			player.close();
+		}
+		else {
+			player.setRealtime(!bReplayFast);
+			player.setLoop(bReplayLoop);
+			ofLogNotice() << "replaying " << replayFile << ": "
+			              << player.getFrameCount() << " frames"
+			              << (bReplayFast ? ", fast" : "");
+		}
+	}
+	
+	// setup kinect, textures are uploaded from the results in update()
+	// and the video stream is only needed when there is something to draw
+	if(!player.isOpen()) {
+		kinect.init(false, !bHeadless || bRecordRGB, false); // no IR image, video, no textures
+		kinect.setRegistration(true);
+		kinect.setDepthClipping(nearClipping, farClipping);
+		kinect.open(kinectID);
+		if(recordFile != "") {
+			startRecording(recordFile);
+		}
+
+		// open additional sensors, each on its own worker thread
+		for(const SensorConfig &config : sensorConfigs) {
+			std::unique_ptr<Sensor> sensor(new Sensor);
+			if(!sensor->setup(config.kinectID, MAX_PERSONS, estimators.data(), estimators.size(),
+			                  sensorSettings(config.kinectID))) {
+				ofLogError() << "couldn't open sensor kinect " << config.kinectID;
+				continue;
+			}
+			sensors.push_back(std::move(sensor));
+		}
+		if(!sensors.empty()) {
+			ofLogNotice() << "fusing " << sensors.size() + 1 << " sensors";
+		}
+	}
+	else if(!sensorConfigs.empty()) {
+		ofLogNotice() << "ignoring additional sensors when replaying";
+	}
+	
+	// setup stats, in Stage order
+	stats.setup(TrackerCore::stageNames(estimators.data(), estimators.size()));
+
+	// setup cv
+	depthImage.allocate(kinect.width, kinect.height, OF_PIXELS_GRAY);
+	core.setup(kinect.width, kinect.height, MAX_PERSONS);
+	core.setEstimators(estimators.data(), estimators.size());
+
+	// camera rays for world coordinates, from the recording's intrinsics when
+	// replaying: typical values are used if there are none
+	if(player.isOpen()) {
+		core.getRays().setup(kinect.width, kinect.height,
+		                     player.getZeroPlanePixelSize(), player.getZeroPlaneDistance());
+	}
+	else {
+		core.getRays().setup(kinect.width, kinect.height,
+		                     kinect.getZeroPlanePixelSize(), kinect.getZeroPlaneDistance());
+	}
+
+	// load the saved background, otherwise learn it from the first frames
+	core.setSettings(coreSettings());
+	if(bBackground && ofFile::doesFileExist(backgroundFile)) {
+		if(core.getBackground().load(ofToDataPath(backgroundFile))) {
+			ofLogNotice() << "loaded background " << backgroundFile;
+		}
+		else {
+			ofLogWarning() << "couldn't load background: " << core.getBackground().getError();
+			core.resetBackground();
+		}
+	}
+
+	// start output & tracking
+	bOutputRunning = true;
+	outputThread = std::thread(&TrackerApp::outputFunction, this);
+	startThread();
+}
+
+//--------------------------------------------------------------
+void TrackerApp::update() {
+	if(bHeadless) {
+		if(bReplayDone) {
+			ofExit();
+		}
+		return;
+	}
+	ofBackground(0, 0, 0);
+
+	// grab the latest tracking results, if there are new ones
+	if(results.update()) {
+		Result &result = results.front();
+		if(result.image.isAllocated()) {
+			// the threshold image is smaller when labelling downsampled
+			if(displayTexture.getWidth() != result.image.getWidth() ||
+			   displayTexture.getHeight() != result.image.getHeight()) {
+				displayTexture.allocate(result.image);
+			}
+			displayTexture.loadData(result.image);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void TrackerApp::draw() {
+	if(bHeadless) {
+		return;
+	}
+	Result &result = results.front();
+	char text[128]; // overlay text, formatted in place
+
+	// draw display image
+	ofSetColor(255);
+	if(result.image.isAllocated() && displayTexture.isAllocated()) {
+		displayTexture.draw(0, 0, kinect.width, kinect.height);
+	}
+
+	// green - search region, when not the full frame
+	if(result.region.width < kinect.width || result.region.height < kinect.height) {
+		ofNoFill();
+		ofSetLineWidth(1.0);
+		ofSetColor(0, 255, 0);
+		ofDrawRectangle(result.region.x, result.region.y, result.region.width, result.region.height);
+	}
+
+	for(const TrackerCore::Person &person : result.persons) {
+
+		// pink - person bounding box
+		ofNoFill();
+		ofSetLineWidth(2.0);
+		ofSetColor(255, 0, 153);
+		ofDrawRectangle(person.blob.x, person.blob.y, person.blob.width, person.blob.height);
+	
+		// purple - found person centroid
+		ofFill();
+		ofSetColor(255, 0, 255);
+		ofDrawRectangle(person.blob.centroidX, person.blob.centroidY, 10, 10);
+
+		drawEstimate(person);
+		
+		for(std::size_t e = 0; e < estimators.size(); ++e) {
+
+			// light blue - estimated position
+			const Position &estimate = person.estimates[e];
+			ofFill();
+			ofSetColor(0, 255, 255);
+			ofDrawRectangle(estimate.x, estimate.y, 10, 10);
+			
+			// draw id & current position
+			const Position &position = person.positions[e];
+			ofSetColor(255);
+			std::snprintf(text, sizeof(text), "%u: %.2f %.2f %.2f", person.id, position.x, position.y, position.z);
+			ofDrawBitmapString(text, estimate.x+12, estimate.y+10);
+		}
+	}
+	
+	ofSetColor(255);
+	std::snprintf(text, sizeof(text), "persons %zu", result.persons.size());
+	ofDrawBitmapString(text, 12, 12);
+	std::snprintf(text, sizeof(text), "threshold %u mm", result.threshold);
+	ofDrawBitmapString(text, 12, 24);
+	if(result.numTiles > 0) {
+		std::snprintf(text, sizeof(text), "frame %llu, %llu dropped, %zu/%zu tiles changed",
+		              (unsigned long long)result.sequence, (unsigned long long)result.dropped,
+		              result.changedTiles, result.numTiles);
+	}
+	else {
+		std::snprintf(text, sizeof(text), "frame %llu, %llu dropped",
+		              (unsigned long long)result.sequence, (unsigned long long)result.dropped);
+	}
+	ofDrawBitmapString(text, 12, 36);
+
+	// stage latencies
+	if(bDrawStats && !result.stats.empty()) {
+		int y = 60;
+		ofDrawBitmapStringHighlight("stage            p50    p95    p99    max ms", 12, y);
+		for(std::size_t i = 0; i < result.stats.size() && i < stats.size(); ++i) {
+			const LatencyStats::Summary &s = result.stats[i];
+			y += 14;
+			std::snprintf(text, sizeof(text), "%-14s %6.2f %6.2f %6.2f %6.2f",
+			              stats.getName(i).c_str(), s.p50, s.p95, s.p99, s.max);
+			ofDrawBitmapStringHighlight(text, 12, y);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void TrackerApp::exit() {
+	waitForThread(true);
+	for(auto &sensor : sensors) {
+		sensor->close();
+	}
+	bOutputRunning = false;
+	outputCondition.notify_one();
+	if(outputThread.joinable()) {
+		outputThread.join();
+	}
+	stopRecording();
+	kinect.close();
+	player.close();
+}
+
+//--------------------------------------------------------------
+bool TrackerApp::startRecording(const std::string &file) {
+	std::unique_lock<std::mutex> lock(mutex);
+	if(player.isOpen()) {
+		ofLogWarning() << "not recording while replaying";
+		return false;
+	}
+	if(!recorder.open(ofToDataPath(file), kinect.width, kinect.height, bRecordRGB,
+	                  kinect.getZeroPlanePixelSize(), kinect.getZeroPlaneDistance())) {
+		ofLogError() << "couldn't start recording: " << recorder.getError();
+		return false;
+	}
+	ofLogNotice() << "recording to " << file;
+	return true;
+}
+
+//--------------------------------------------------------------
+void TrackerApp::stopRecording() {
+	std::unique_lock<std::mutex> lock(mutex);
+	if(recorder.isOpen()) {
+		ofLogNotice() << "recorded " << recorder.getFrameCount() << " frames";
+		recorder.close();
+	}
+}
+
+//--------------------------------------------------------------
+void TrackerApp::threadedFunction() {
+	while(isThreadRunning()) {
+		if(player.isOpen()) {
+			// waits to keep the recorded pace unless replaying fast
+			if(!player.nextFrame()) {
+				ofLogNotice() << "replay finished";
+				bReplayDone = true;
+				break;
+			}
+		}
+		else {
+			kinect.update();
+			if(!kinect.isFrameNewDepth()) {
+				// ofxKinect doesn't provide a frame callback, so poll at a short
+				// interval instead of waiting for the next render frame
+				sleep(1);
+				continue;
+			}
+		}
+		std::unique_lock<std::mutex> lock(mutex);
+		processFrame();
+	}
+}
+
+//--------------------------------------------------------------
+void TrackerApp::processFrame() {
+	Result &result = results.back();
+	result.threshold = threshold;
+	std::uint64_t frameTime = ofGetElapsedTimeMicros();
+	std::uint64_t frameClock = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count(); // for receivers
+	std::uint64_t captureTime = FrameLog::now();
+	stats.startFrame();
+
+	// grab raw depth frame & count the frames missed since the last one
+	std::uint64_t step = 1;
+	if(player.isOpen()) {
+		// read straight from the mapped recording
+		rawDepth = player.getDepth();
+		std::uint32_t sequence = player.getSequence();
+		if(sequence > lastRecordedSequence) {
+			step = sequence - lastRecordedSequence; // 1 unless skipped, or looped
+		}
+		lastRecordedSequence = sequence;
+	}
+	else {
+		// use the kinect buffer in place
+		rawDepth = kinect.getRawDepthPixels().getData();
+		if(lastCaptureTime > 0) {
+			step = (captureTime - lastCaptureTime + KINECT_FRAME_US / 2) / KINECT_FRAME_US;
+			step = MAX(step, 1);
+		}
+	}
+	if(frameSequence > 0) {
+		droppedFrames += step - 1;
+	}
+	frameSequence += (frameSequence > 0 ? step : 1);
+	lastCaptureTime = captureTime;
+	if(recorder.isOpen() && !player.isOpen()) {
+		// keep the live sequence so gaps are still counted on replay
+		recorder.addFrame(rawDepth, kinect.getPixels().getData(),
+		                  captureTime, (std::uint32_t)frameSequence);
+	}
+	result.sequence = frameSequence;
+	result.dropped = droppedFrames;
+	stats.lap(TrackerCore::STAGE_GRAB);
+
+	// find person-sized blobs & estimate their positions, only within the
+	// search region when predicting
+	DepthFrame frame;
+	frame.raw = rawDepth;
+	frame.rawStride = kinect.width;
+	frame.width = kinect.width;
+	frame.height = kinect.height;
+	core.setSettings(coreSettings());
+	core.process(frame, &stats);
+	result.region = core.getRegion();
+	result.changedTiles = core.getNumChangedTiles();
+	result.numTiles = (bIncremental ? core.getNumTiles() : 0);
+	result.persons.resize(core.size());
+	for(std::size_t i = 0; i < core.size(); ++i) {
+		result.persons[i] = core[i];
+	}
+
+	// targets to track & output: the persons found here or, with additional
+	// sensors, everyone seen by any sensor merged in world coordinates,
+	// matched to tracks with persistent ids
+	std::size_t numTargets = 0;
+	if(sensors.empty()) {
+		core.track();
+		numTargets = core.size();
+		for(std::size_t i = 0; i < numTargets; ++i) {
+			for(std::size_t e = 0; e < estimators.size(); ++e) {
+				const Position &position = core[i].positions[e];
+				targets[i].positions[e] = glm::vec3(position.x, position.y, position.z);
+			}
+			targets[i].id = core[i].id;
+			result.persons[i].id = core[i].id;
+		}
+	}
+	else {
+		numTargets = fuseSensors(core.getFrame());
+		core.track(detections, numTargets);
+		for(std::size_t i = 0; i < numTargets; ++i) {
+			targets[i].id = core.getTracker().getId(i);
+		}
+		for(std::size_t i = 0; i < result.persons.size(); ++i) {
+			result.persons[i].id = (personTargets[i] < 0 ? 0 : targets[personTargets[i]].id);
+		}
+	}
+	stats.lap(TrackerCore::STAGE_TRACK);
+
+	// filter positions, output slots follow the tracks so there's always one
+	// free for a new person
+	for(const PersonTracker::Event &event : core.getTracker().getEvents()) {
+		if(!outputEvents.push(event)) {
+			ofLogWarning() << "output falling behind, dropped event for " << event.id;
+		}
+		for(Output &output : outputs) {
+			if(output.id == event.id) {
+				output.id = 0;
+			}
+		}
+	}
+	for(Output &output : outputs) {
+		output.bFound = false;
+	}
+	for(std::size_t i = 0; i < numTargets; ++i) {
+		const Target &target = targets[i];
+		if(target.id == 0) {
+			continue; // no room to track
+		}
+		Output *output = nullptr;
+		for(Output &o : outputs) {
+			if(o.id == target.id) {
+				output = &o;
+				break;
+			}
+			if(!output && o.id == 0) {
+				output = &o;
+			}
+		}
+		if(!output) {
+			break; // shouldn't happen, there's a slot for every track
+		}
+		bool bNew = (output->id != target.id);
+		output->id = target.id;
+		output->bFound = true;
+		for(std::size_t e = 0; e < estimators.size(); ++e) {
+			Output::Channel &channel = output->channels[e];
+			const glm::vec3 &position = target.positions[e];
+			if(bNew) {
+				channel.x.reset();
+				channel.y.reset();
+				channel.z.reset();
+			}
+			if(bFilter) {
+				double time = frameTime / 1000000.0;
+				channel.x.setup(filterMinCutoff, filterBeta, filterDerivativeCutoff);
+				channel.y.setup(filterMinCutoff, filterBeta, filterDerivativeCutoff);
+				channel.z.setup(filterMinCutoff, filterBeta, filterDerivativeCutoff);
+				channel.position = glm::vec3(channel.x.filter(position.x, time),
+				                             channel.y.filter(position.y, time),
+				                             channel.z.filter(position.z, time));
+				channel.velocity = glm::vec3(channel.x.getVelocity(),
+				                             channel.y.getVelocity(),
+				                             channel.z.getVelocity());
+			}
+			else {
+				channel.position = position;
+				channel.velocity = glm::vec3(0, 0, 0);
+			}
+		}
+	}
+	stats.lap(TrackerCore::STAGE_FILTER);
+
+	// hand the found tracks to the output thread & wake it, the latest stats
+	// ride along & are sent when they change
+	OutputFrame &output = outputFrames.back();
+	output.numTracks = 0;
+	for(const Output &o : outputs) {
+		if(o.id == 0 || !o.bFound) {
+			continue;
+		}
+		OutputFrame::Track &track = output.tracks[output.numTracks++];
+		track.id = o.id;
+		for(std::size_t e = 0; e < estimators.size(); ++e) {
+			track.positions[e] = o.channels[e].position;
+			track.velocities[e] = o.channels[e].velocity;
+		}
+	}
+	output.time = frameTime;
+	output.timetag = OscPacket::timetag(frameClock);
+	output.sequence = frameSequence;
+	output.captureTime = captureTime;
+	output.dropped = droppedFrames;
+	output.bBundle = bBundle;
+	output.bSendLatency = bSendLatency;
+	output.period = (outputRate > 0 ? 1000000 / outputRate : 0);
+	output.lookahead = lookahead * 1000;
+	output.statsTime = (bSendStats ? statsTime : 0);
+	output.stats = statsSummary;
+	outputFrames.publish();
+	bOutputPending = true;
+	outputCondition.notify_one();
+
+	// same-host clients poll the latest tracks from shared memory instead
+	if(shm.isOpen()) {
+		qdtshm_frame &tracks = shm.begin();
+		tracks.numTracks = 0;
+		for(std::size_t i = 0; i < output.numTracks && i < QDTSHM_MAX_TRACKS; ++i) {
+			qdtshm_track &track = tracks.tracks[tracks.numTracks++];
+			track.id = output.tracks[i].id;
+			for(std::size_t e = 0; e < estimators.size() && e < QDTSHM_MAX_ESTIMATORS; ++e) {
+				const glm::vec3 &position = output.tracks[i].positions[e];
+				track.positions[e][0] = position.x;
+				track.positions[e][1] = position.y;
+				track.positions[e][2] = position.z;
+			}
+		}
+		shm.publish(frameClock);
+	}
+	stats.lap(TrackerCore::STAGE_SEND);
+	stats.endFrame();
+
+	// update stats periodically
+	std::uint64_t now = ofGetElapsedTimeMillis();
+	if(now - statsTime >= statsInterval * 1000) {
+		stats.summarize(statsSummary);
+		statsTime = now;
+	}
+	result.stats = statsSummary;
+
+	// copy display image for draw()
+	switch(bHeadless ? NONE : displayImage) {
+		case THRESHOLD:
+			result.image.setFromPixels(core.getMask(), core.getMaskWidth(), core.getMaskHeight(), OF_PIXELS_GRAY);
+			break;
+		case RGB:
+			if(!player.isOpen()) {
+				result.image = kinect.getPixels();
+			}
+			else if(player.hasRGB()) {
+				result.image.setFromPixels(player.getRGB(), kinect.width, kinect.height, OF_PIXELS_RGB);
+			}
+			else {
+				result.image.clear();
+			}
+			break;
+		case DEPTH:
+			if(!player.isOpen() && !bDenoise) {
+				result.image = kinect.getDepthPixels();
+			}
+			else {
+				// only converted to grayscale when displayed, denoised when enabled
+				convertDepth(core.getFrame().raw, depthImage.getData(), depthImage.getWidth() * depthImage.getHeight(),
+				             depthLookup.data(), depthLookup.size());
+				result.image = depthImage;
+			}
+			break;
+		default: // NONE
+			result.image.clear();
+			break;
+	}
+
+	results.publish();
+}
+
+//--------------------------------------------------------------
+void TrackerApp::outputFunction() {
+	std::uint64_t next = ofGetElapsedTimeMicros();
+	std::uint64_t statsSent = 0;
+	std::uint64_t sequenceSent = 0; // last frame sent to /qdtracker/frame & logged
+	while(bOutputRunning) {
+
+		// (re)open the sender here, resolving the hosts may take a while
+		if(bSenderChanged.exchange(false)) {
+			std::string address;
+			unsigned int port;
+			int ttl;
+			{
+				std::unique_lock<std::mutex> lock(senderMutex);
+				address = senderAddress;
+				port = senderPort;
+				ttl = senderTTL;
+			}
+			if(!sender.setup(address, port, ttl)) {
+				ofLogError() << "couldn't setup osc sender: " << sender.getError();
+			}
+		}
+
+		// save the sent frames, only on request so it can take its time
+		if(bSaveFrameLog.exchange(false)) {
+			std::string file = "latency-" + ofGetTimestampString("%Y-%m-%d-%H-%M-%S") + ".csv";
+			if(frameLog.save(ofToDataPath(file))) {
+				ofLogNotice() << "saved " << frameLog.size() << " frames to " << file;
+			}
+			else {
+				ofLogError() << "couldn't save latency log: " << frameLog.getError();
+			}
+		}
+
+		bOutputPending = false;
+		bool bNew = outputFrames.update();
+		const OutputFrame &frame = outputFrames.front();
+		std::uint64_t now = ofGetElapsedTimeMicros();
+		if(frame.period == 0 && !bNew) {
+			// send each new frame as soon as it's handed over, the timeout
+			// covers a wake up missed between checking & waiting
+			std::unique_lock<std::mutex> lock(outputWaitMutex);
+			outputCondition.wait_for(lock, std::chrono::milliseconds(5), [this] {
+				return bOutputPending || !bOutputRunning;
+			});
+			next = ofGetElapsedTimeMicros();
+			continue;
+		}
+
+		// events are never coalesced & go out first, in order, then the stats
+		// when they change & the positions: when bundling, all of them are
+		// sent at once stamped with the frame capture time
+		bBundling = frame.bBundle;
+		if(bBundling) {
+			packet.beginBundle(frame.timetag);
+		}
+		// frames are resent when sending at a fixed rate, only send & log
+		// each one's latency once
+		bool bNewSequence = (frame.sequence > sequenceSent);
+		if(frame.bSendLatency && bNewSequence) {
+			packet.begin("/qdtracker/frame", "hhfh");
+			packet.addInt64(frame.sequence);
+			packet.addInt64(frame.captureTime);
+			packet.addFloat((FrameLog::now() - frame.captureTime) / 1000.0f);
+			packet.addInt64(frame.dropped);
+			sendMessage();
+		}
+		PersonTracker::Event event;
+		while(outputEvents.pop(event)) {
+			packet.begin(event.type == PersonTracker::ENTER ? "/enter" : "/leave", "i");
+			packet.addInt(event.id);
+			sendMessage();
+		}
+		if(frame.statsTime != statsSent) {
+			sendStats(frame.stats);
+			statsSent = frame.statsTime;
+		}
+		sendOutput(frame, now);
+		if(bBundling) {
+			packet.endBundle();
+			if(packet.getNumMessages() > 0) {
+				sender.send(packet.getData(), packet.getSize());
+			}
+			if(!packet.isOk()) {
+				ofLogWarning() << "osc bundle full, dropped messages";
+			}
+			bBundling = false;
+		}
+		if(bNewSequence) {
+			FrameLog::Entry entry;
+			entry.sequence = frame.sequence;
+			entry.captureTime = frame.captureTime;
+			entry.sendTime = FrameLog::now();
+			entry.dropped = frame.dropped;
+			frameLog.add(entry);
+			sequenceSent = frame.sequence;
+		}
+		if(frame.period == 0) {
+			continue;
+		}
+
+		// keep a steady rate, but don't try to catch up after a stall
+		next += frame.period;
+		if(next < now) {
+			next = now + frame.period;
+		}
+		std::this_thread::sleep_for(std::chrono::microseconds(next - now));
+	}
+}
+
+//--------------------------------------------------------------
+void TrackerApp::sendOutput(const OutputFrame &frame, std::uint64_t now) {
+
+	// send positions, extrapolated from the frame time to make up for the
+	// pipeline latency: limited in case frames stop arriving
+	float ahead = MIN((float)(now - frame.time + frame.lookahead) / 1000000.0, 0.1);
+	for(std::size_t i = 0; i < frame.numTracks; ++i) {
+		const OutputFrame::Track &track = frame.tracks[i];
+		for(std::size_t e = 0; e < positionAddresses.size(); ++e) {
+			glm::vec3 position = track.positions[e] + track.velocities[e] * ahead;
+			packet.begin(positionAddresses[e].c_str(), "ifff");
+			packet.addInt(track.id);
+			packet.addFloat(position.x);
+			packet.addFloat(position.y);
+			packet.addFloat(position.z);
+			sendMessage();
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void TrackerApp::sendStats(const std::vector<LatencyStats::Summary> &summaries) {
+	for(std::size_t i = 0; i < summaries.size(); ++i) {
+		packet.begin("/qdtracker/stats", "sffff");
+		packet.addString(stats.getName(i).c_str());
+		packet.addFloat(summaries[i].p50);
+		packet.addFloat(summaries[i].p95);
+		packet.addFloat(summaries[i].p99);
+		packet.addFloat(summaries[i].max);
+		sendMessage();
+	}
+}
+
+//--------------------------------------------------------------
+void TrackerApp::sendMessage() {
+	if(!bBundling && packet.isOk()) {
+		sender.send(packet.getData(), packet.getSize());
+	}
+}
+
+//--------------------------------------------------------------
+void TrackerApp::setSender(const std::string &address, unsigned int port, int ttl) {
+	std::unique_lock<std::mutex> lock(senderMutex);
+	senderAddress = address;
+	senderPort = port;
+	senderTTL = ttl;
+	bSenderChanged = true;
+}
+
+//--------------------------------------------------------------
+void TrackerApp::setupShm() {
+	if(!bShm) {
+		shm.close();
+		return;
+	}
+	if(!shm.setup(shmName, positionAddresses.data(), positionAddresses.size())) {
+		ofLogError() << "couldn't setup shared memory output: " << shm.getError();
+	}
+}
+
+//--------------------------------------------------------------
+std::size_t TrackerApp::fuseSensors(const DepthFrame &frame) {
+	std::size_t count = 0;
+
+	// keep the additional sensors' settings in step, handed over lock-free so
+	// this never waits on a sensor's frame
+	for(auto &sensor : sensors) {
+		sensor->setSettings(sensorSettings(sensor->getKinectID()));
+	}
+
+	// persons found here
+	glm::mat4 transform = sensorTransform(sensorPosition, sensorRotation);
+	glm::vec3 positions[MAX_ESTIMATORS];
+	for(std::size_t i = 0; i < core.size(); ++i) {
+		const Position *estimates = core[i].estimates;
+		if(core.getRays().unprojectAt(frame, estimates[0].x, estimates[0].y).z <= 0) {
+			personTargets[i] = -1; // no depth here
+			continue;
+		}
+		for(std::size_t e = 0; e < estimators.size(); ++e) {
+			Position camera = core.getRays().unprojectAt(frame, estimates[e].x, estimates[e].y);
+			positions[e] = glm::vec3(transform * glm::vec4(camera.x, camera.y, camera.z, 1));
+		}
+		personTargets[i] = fuseTarget(positions, count);
+	}
+
+	// persons found by the additional sensors, skipping any that stopped
+	std::uint64_t now = ofGetElapsedTimeMicros();
+	for(auto &sensor : sensors) {
+		const Sensor::Frame &frame = sensor->getFrame();
+		if(frame.time == 0 || frame.time + 500000 < now) {
+			continue;
+		}
+		for(std::size_t i = 0; i + estimators.size() <= frame.positions.size(); i += estimators.size()) {
+			fuseTarget(&frame.positions[i], count);
+		}
+	}
+
+	// track on the floor by the primary position, then scale for output
+	for(std::size_t i = 0; i < count; ++i) {
+		Target &target = targets[i];
+		detections[i].x = target.positions[0].x;
+		detections[i].y = target.positions[0].z;
+		detections[i].width = 0;
+		detections[i].height = 0;
+		for(std::size_t e = 0; e < estimators.size(); ++e) {
+			glm::vec3 &position = target.positions[e];
+			if(bScaleX) position.x *= scaleXAmt;
+			if(bScaleY) position.y *= scaleYAmt;
+			if(bScaleZ) position.z *= scaleZAmt;
+		}
+	}
+	return count;
+}
+
+//--------------------------------------------------------------
+int TrackerApp::fuseTarget(const glm::vec3 *positions, std::size_t &count) {
+
+	// seen by another sensor? average the positions
+	for(std::size_t i = 0; i < count; ++i) {
+		Target &target = targets[i];
+		glm::vec2 floor(positions[0].x - target.positions[0].x, positions[0].z - target.positions[0].z);
+		if(glm::length(floor) < fuseDistance) {
+			target.sensors++;
+			for(std::size_t e = 0; e < estimators.size(); ++e) {
+				target.positions[e] += (positions[e] - target.positions[e]) / (float)target.sensors;
+			}
+			return i;
+		}
+	}
+	if(count >= MAX_PERSONS) {
+		return -1;
+	}
+	for(std::size_t e = 0; e < estimators.size(); ++e) {
+		targets[count].positions[e] = positions[e];
+	}
+	targets[count].sensors = 1;
+	return count++;
+}
+
+//--------------------------------------------------------------
+TrackerCore::Settings TrackerApp::coreSettings() {
+	TrackerCore::Settings settings;
+	settings.threshold = threshold;
+	settings.personMinArea = personMinArea;
+	settings.personMaxArea = personMaxArea;
+	settings.maxPersons = maxPersons;
+	settings.trackDistance = trackDistance;
+	settings.trackMissedFrames = trackMissedFrames;
+	settings.bPredictRegion = bPredictRegion;
+	settings.regionPadding = regionPadding;
+	settings.fullScanFrames = fullScanFrames;
+	settings.pyramidLevel = pyramidLevel;
+	settings.threads = threads;
+	settings.bIncremental = bIncremental;
+	settings.changeTolerance = changeTolerance;
+	settings.changeThreshold = changeThreshold;
+	if(bDenoise) {
+		settings.denoise.bFillHoles = bFillHoles;
+		settings.denoise.medianSize = medianSize;
+		settings.denoise.smoothing = smoothing;
+		settings.denoise.smoothingJump = smoothingJump;
+	}
+	settings.bBackground = bBackground;
+	settings.backgroundMargin = backgroundMargin;
+	settings.backgroundRate = backgroundRate;
+	settings.backgroundLearnFrames = backgroundLearnFrames;
+
+	Transform &transform = settings.transform;
+	transform.bWorld = bWorldCoordinates;
+	glm::mat4 world = sensorTransform(sensorPosition, sensorRotation);
+	for(int row = 0; row < 3; ++row) {
+		for(int col = 0; col < 4; ++col) {
+			transform.world[row * 4 + col] = world[col][row]; // glm is column major
+		}
+	}
+	transform.bNormalizeX = bNormalizeX;
+	transform.bNormalizeY = bNormalizeY;
+	transform.bNormalizeZ = bNormalizeZ;
+	transform.bScaleX = bScaleX;
+	transform.bScaleY = bScaleY;
+	transform.bScaleZ = bScaleZ;
+	transform.scaleXAmt = scaleXAmt;
+	transform.scaleYAmt = scaleYAmt;
+	transform.scaleZAmt = scaleZAmt;
+	transform.width = kinect.width;
+	transform.height = kinect.height;
+	transform.depthNear = kinect.getNearClipping();
+	transform.depthFar = kinect.getFarClipping();
+	return settings;
+}
+
+//--------------------------------------------------------------
+Sensor::Settings TrackerApp::sensorSettings(unsigned int kinectID) {
+	Sensor::Settings settings;
+	settings.tracking = coreSettings();
+	settings.nearClipping = nearClipping;
+	settings.farClipping = farClipping;
+	for(const SensorConfig &config : sensorConfigs) {
+		if(config.kinectID == kinectID) {
+			settings.transform = sensorTransform(config.position, config.rotation);
+			break;
+		}
+	}
+	return settings;
+}
+
+//--------------------------------------------------------------
+glm::mat4 TrackerApp::sensorTransform(const glm::vec3 &position, const glm::vec3 &rotation) {
+	return glm::translate(glm::mat4(1.0), position) *
+	       glm::mat4_cast(glm::quat(glm::radians(rotation)));
+}
+
+//--------------------------------------------------------------
+void TrackerApp::updateDepthLookup() {
+	depthLookup.resize(10001); // kinect max depth in mm + 1
+	buildDepthLookup(depthLookup.data(), depthLookup.size(), nearClipping, farClipping);
+}
+
+//--------------------------------------------------------------
+void TrackerApp::keyPressed(int key) {
+	std::unique_lock<std::mutex> lock(mutex);
+	switch(key) {
+		
+		case '-':
+			threshold = (threshold > 10 ? threshold - 10 : 0);
+			break;
+			
+		case '=':
+			threshold += 10;
+			if(threshold > 10000) threshold = 10000;
+			break;
+			
+		case 'i':
+			bIncremental = !bIncremental;
+			break;
+			
+		case 'n':
+			bDenoise = !bDenoise;
+			break;
+			
+		case 'w':
+			bWorldCoordinates = !bWorldCoordinates;
+			break;
+			
+		case 'x':
+			bNormalizeX = !bNormalizeX;
+			break;
+			
+		case 'y':
+			bNormalizeY = !bNormalizeY;
+			break;
+			
+		case 'z':
+			bNormalizeZ = !bNormalizeZ;
+			break;
+			
+		case 'd': {
+			// increment enum
+			int d = (int)displayImage;
+			d++;
+			if(d > DEPTH) {
+				d = (int)NONE;
+			}
+			displayImage = (DisplayImage)d;
+			break;
+		}
+
+		case 't':
+			bDrawStats = !bDrawStats;
+			break;
+
+		case 'b':
+			// learn the background again, ie. after moving furniture
+			core.setSettings(coreSettings());
+			core.resetBackground();
+			for(auto &sensor : sensors) {
+				sensor->resetBackground();
+			}
+			ofLogNotice() << "learning background";
+			break;
+	}
+	lock.unlock();
+
+	// settings & recording functions lock on their own
+	switch(key) {
+
+		case 'r':
+			if(recorder.isOpen()) {
+				stopRecording();
+			}
+			else {
+				startRecording(ofGetTimestampString("%Y-%m-%d-%H-%M-%S")+".qdt");
+			}
+			break;
+			
+		case 's':
+			saveSettings();
+			break;
+			
+		case 'l':
+			loadSettings();
+			break;
+			
+		case 'R':
+			resetSettings();
+			break;
+
+		case 'L':
+			bSaveFrameLog = true;
+			break;
+	}
+}
+
+// settings xml x, y, & z children
+//--------------------------------------------------------------
+static glm::vec3 getVec3(const ofXml &xml) {
+	return glm::vec3(xml.getChild("x").getFloatValue(),
+	                 xml.getChild("y").getFloatValue(),
+	                 xml.getChild("z").getFloatValue());
+}
+
+//--------------------------------------------------------------
+static void setVec3(ofXml xml, const glm::vec3 &v) {
+	xml.appendChild("x").set(v.x);
+	xml.appendChild("y").set(v.y);
+	xml.appendChild("z").set(v.z);
+}
+
+//--------------------------------------------------------------
+void TrackerApp::resetSettings() {
+	std::unique_lock<std::mutex> lock(mutex);
+	
+	threshold = 1800;
+	nearClipping = 500;
+	farClipping = 4000;
+	personMinArea = 3000;
+	personMaxArea = 640*480*0.5;
+	maxPersons = 4;
+	trackDistance = 100;
+	trackMissedFrames = 10;
+	bPredictRegion = false;
+	regionPadding = 40;
+	fullScanFrames = 30;
+	pyramidLevel = 0;
+	threads = 1;
+	resetEstimatorSettings();
+
+	bIncremental = false;
+	changeTolerance = 30;
+	changeThreshold = 4096;
+	
+	bDenoise = false;
+	bFillHoles = true;
+	medianSize = 3;
+	smoothing = 0.5;
+	smoothingJump = 100;
+	
+	bBackground = false;
+	backgroundMargin = 100;
+	backgroundRate = 0.1;
+	backgroundLearnFrames = 90;
+	backgroundFile = "background.qdb";
+	
+	bWorldCoordinates = false;
+	
+	bNormalizeX = false;
+	bNormalizeY = false;
+	bNormalizeZ = false;
+	
+	bScaleX = false;
+	bScaleY = false;
+	bScaleZ = false;
+	
+	scaleXAmt = 1.0;
+	scaleYAmt = 1.0;
+	scaleZAmt = 1.0;
+	
+	displayImage = THRESHOLD;
+	kinectID = 0;
+	sensorPosition = glm::vec3(0, 0, 0);
+	sensorRotation = glm::vec3(0, 0, 0);
+	sensorConfigs.clear();
+	fuseDistance = 300;
+	bRecordRGB = false;
+
+	bSendStats = false;
+	bSendLatency = false;
+	bDrawStats = false;
+	statsInterval = 1.0;
+	
+	sendAddress = "127.0.0.1";
+	sendPort = 9000;
+	bBundle = true;
+	multicastTTL = 1;
+	bShm = false;
+	shmName = "/qdtracker";
+
+	outputRate = 0;
+	bFilter = false;
+	filterMinCutoff = 1.0;
+	filterBeta = 0.1;
+	filterDerivativeCutoff = 1.0;
+	lookahead = 0;
+
+	// setup kinect
+	kinect.setDepthClipping(nearClipping, farClipping);
+	updateDepthLookup();
+
+	// estimator settings changed, ie. the top band
+	core.setEstimators(estimators.data(), estimators.size());
+	for(auto &sensor : sensors) {
+		sensor->setEstimators(estimators.data(), estimators.size());
+	}
+
+	// setup osc
+	setSender(sendAddress, sendPort, multicastTTL);
+	setupShm();
+}
+
+//--------------------------------------------------------------
+bool TrackerApp::loadSettings(const std::string xmlFile) {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	ofXml xml;
+	if(!xml.load(xmlFile)) {
+		ofLogWarning() << "Couldn't load settings ";
+		return false;
+	}
+
+	ofXml root = xml.getChild("settings");
+	if(!root) {
+		ofLogWarning() << "Couldn't load settings, missing root \"settings\" tag";
+		return false;
+	}
+
+	kinectID = root.getChild("kinectID").getUintValue();
+	displayImage = (DisplayImage)root.getChild("displayImage").getUintValue();
+
+	ofXml sensorsXml = root.getChild("sensors");
+	if(sensorsXml) {
+		sensorPosition = getVec3(sensorsXml.getChild("position"));
+		sensorRotation = getVec3(sensorsXml.getChild("rotation"));
+		fuseDistance = sensorsXml.getChild("fuseDistance").getFloatValue();
+		sensorConfigs.clear();
+		for(auto sensorXml : sensorsXml.getChildren("sensor")) {
+			SensorConfig config;
+			config.kinectID = sensorXml.getChild("kinectID").getUintValue();
+			config.position = getVec3(sensorXml.getChild("position"));
+			config.rotation = getVec3(sensorXml.getChild("rotation"));
+			sensorConfigs.push_back(config);
+		}
+	}
+
+	ofXml tracking = root.getChild("tracking");
+	if(tracking) {
+		threshold = tracking.getChild("threshold").getUintValue();
+		nearClipping = tracking.getChild("nearClipping").getUintValue();
+		farClipping = tracking.getChild("farClipping").getUintValue();
+		personMinArea = tracking.getChild("personMinArea").getUintValue();
+		personMaxArea = tracking.getChild("personMaxArea").getUintValue();
+		maxPersons = ofClamp(tracking.getChild("maxPersons").getUintValue(), 1, MAX_PERSONS);
+		trackDistance = tracking.getChild("trackDistance").getFloatValue();
+		trackMissedFrames = tracking.getChild("trackMissedFrames").getUintValue();
+		bPredictRegion = tracking.getChild("bPredictRegion").getBoolValue();
+		regionPadding = tracking.getChild("regionPadding").getUintValue();
+		fullScanFrames = tracking.getChild("fullScanFrames").getUintValue();
+		pyramidLevel = ofClamp(tracking.getChild("pyramidLevel").getUintValue(), 0, MAX_PYRAMID_LEVEL);
+		threads = ofClamp(tracking.getChild("threads").getUintValue(), 1, MAX_THREADS);
+		loadEstimatorSettings(tracking);
+	}
+
+	ofXml incremental = root.getChild("incremental");
+	if(incremental) {
+		bIncremental = incremental.getChild("bIncremental").getBoolValue();
+		changeTolerance = incremental.getChild("tolerance").getUintValue();
+		changeThreshold = incremental.getChild("threshold").getUintValue();
+	}
+
+	ofXml denoise = root.getChild("denoise");
+	if(denoise) {
+		bDenoise = denoise.getChild("bDenoise").getBoolValue();
+		bFillHoles = denoise.getChild("bFillHoles").getBoolValue();
+		medianSize = denoise.getChild("medianSize").getUintValue();
+		smoothing = ofClamp(denoise.getChild("smoothing").getFloatValue(), 0, 1);
+		smoothingJump = denoise.getChild("smoothingJump").getUintValue();
+	}
+
+	ofXml background = root.getChild("background");
+	if(background) {
+		bBackground = background.getChild("bBackground").getBoolValue();
+		backgroundMargin = background.getChild("margin").getUintValue();
+		backgroundRate = background.getChild("rate").getFloatValue();
+		backgroundLearnFrames = background.getChild("learnFrames").getUintValue();
+		backgroundFile = background.getChild("file").getValue();
+	}
+
+	ofXml world = root.getChild("world");
+	if(world) {
+		bWorldCoordinates = world.getChild("bWorldCoordinates").getBoolValue();
+	}
+
+	ofXml normalize = root.getChild("normalize");
+	if(normalize) {
+		bNormalizeX = normalize.getChild("bNormalizeX").getBoolValue();
+		bNormalizeY = normalize.getChild("bNormalizeY").getBoolValue();
+		bNormalizeZ = normalize.getChild("bNormalizeZ").getBoolValue();
+	}
+
+	ofXml scale = root.getChild("scale");
+	if(scale) {
+		bScaleX = scale.getChild("bScaleX").getBoolValue();
+		bScaleY = scale.getChild("bScaleY").getBoolValue();
+		bScaleZ = scale.getChild("bScaleZ").getBoolValue();
+		scaleXAmt = scale.getChild("scaleXAmt").getFloatValue();
+		scaleYAmt = scale.getChild("scaleYAmt").getFloatValue();
+		scaleZAmt = scale.getChild("scaleZAmt").getFloatValue();
+	}
+
+	ofXml osc = root.getChild("osc");
+	if(osc) {
+		sendAddress = osc.getChild("sendAddress").getValue();
+		sendPort = osc.getChild("sendPort").getUintValue();
+		bBundle = osc.getChild("bBundle").getBoolValue();
+		multicastTTL = ofClamp(osc.getChild("multicastTTL").getIntValue(), 0, 255);
+	}
+
+	ofXml shmXml = root.getChild("shm");
+	if(shmXml) {
+		bShm = shmXml.getChild("bShm").getBoolValue();
+		shmName = shmXml.getChild("name").getValue();
+	}
+
+	ofXml output = root.getChild("output");
+	if(output) {
+		outputRate = output.getChild("rate").getFloatValue();
+		bFilter = output.getChild("bFilter").getBoolValue();
+		filterMinCutoff = output.getChild("minCutoff").getFloatValue();
+		filterBeta = output.getChild("beta").getFloatValue();
+		filterDerivativeCutoff = output.getChild("derivativeCutoff").getFloatValue();
+		lookahead = output.getChild("lookahead").getFloatValue();
+	}
+
+	ofXml record = root.getChild("record");
+	if(record) {
+		bRecordRGB = record.getChild("rgb").getBoolValue();
+	}
+
+	ofXml statsXml = root.getChild("stats");
+	if(statsXml) {
+		bSendStats = statsXml.getChild("bSendStats").getBoolValue();
+		bSendLatency = statsXml.getChild("bSendLatency").getBoolValue();
+		bDrawStats = statsXml.getChild("bDrawStats").getBoolValue();
+		statsInterval = statsXml.getChild("interval").getFloatValue();
+	}
+	
+	// setup kinect
+	kinect.setDepthClipping(nearClipping, farClipping);
+	updateDepthLookup();
+
+	// estimator settings changed, ie. the top band
+	core.setEstimators(estimators.data(), estimators.size());
+	for(auto &sensor : sensors) {
+		sensor->setEstimators(estimators.data(), estimators.size());
+	}
+	
+	// setup osc
+	setSender(sendAddress, sendPort, multicastTTL);
+	setupShm();
+	
+	return true;
+}
+
+//--------------------------------------------------------------
+bool TrackerApp::saveSettings(const std::string xmlFile) {
+	std::unique_lock<std::mutex> lock(mutex);
+	
+	ofXml xml;
+
+	ofXml root = xml.appendChild("settings");
+	root.appendChild("kinectID").set(kinectID);
+	root.appendChild("displayImage").set(displayImage);
+	root.appendChild("headless").set(bHeadless);
+
+	ofXml sensorsXml = root.appendChild("sensors");
+	setVec3(sensorsXml.appendChild("position"), sensorPosition);
+	setVec3(sensorsXml.appendChild("rotation"), sensorRotation);
+	sensorsXml.appendChild("fuseDistance").set(fuseDistance);
+	for(const SensorConfig &config : sensorConfigs) {
+		ofXml sensorXml = sensorsXml.appendChild("sensor");
+		sensorXml.appendChild("kinectID").set(config.kinectID);
+		setVec3(sensorXml.appendChild("position"), config.position);
+		setVec3(sensorXml.appendChild("rotation"), config.rotation);
+	}
+
+	ofXml tracking = root.appendChild("tracking");
+	tracking.appendChild("threshold").set(threshold);
+	tracking.appendChild("nearClipping").set(nearClipping);
+	tracking.appendChild("farClipping").set(farClipping);
+	tracking.appendChild("personMinArea").set(personMinArea);
+	tracking.appendChild("personMaxArea").set(personMaxArea);
+	tracking.appendChild("maxPersons").set(maxPersons);
+	tracking.appendChild("trackDistance").set(trackDistance);
+	tracking.appendChild("trackMissedFrames").set(trackMissedFrames);
+	tracking.appendChild("bPredictRegion").set(bPredictRegion);
+	tracking.appendChild("regionPadding").set(regionPadding);
+	tracking.appendChild("fullScanFrames").set(fullScanFrames);
+	tracking.appendChild("pyramidLevel").set(pyramidLevel);
+	tracking.appendChild("threads").set(threads);
+	saveEstimatorSettings(tracking);
+
+	ofXml incremental = root.appendChild("incremental");
+	incremental.appendChild("bIncremental").set(bIncremental);
+	incremental.appendChild("tolerance").set(changeTolerance);
+	incremental.appendChild("threshold").set(changeThreshold);
+
+	ofXml denoise = root.appendChild("denoise");
+	denoise.appendChild("bDenoise").set(bDenoise);
+	denoise.appendChild("bFillHoles").set(bFillHoles);
+	denoise.appendChild("medianSize").set(medianSize);
+	denoise.appendChild("smoothing").set(smoothing);
+	denoise.appendChild("smoothingJump").set(smoothingJump);
+
+	ofXml background = root.appendChild("background");
+	background.appendChild("bBackground").set(bBackground);
+	background.appendChild("margin").set(backgroundMargin);
+	background.appendChild("rate").set(backgroundRate);
+	background.appendChild("learnFrames").set(backgroundLearnFrames);
+	background.appendChild("file").set(backgroundFile);
+
+	ofXml world = root.appendChild("world");
+	world.appendChild("bWorldCoordinates").set(bWorldCoordinates);
+
+	ofXml normalize = root.appendChild("normalize");
+	normalize.appendChild("bNormalizeX").set(bNormalizeX);
+	normalize.appendChild("bNormalizeY").set(bNormalizeY);
+	normalize.appendChild("bNormalizeZ").set(bNormalizeZ);
+
+	ofXml scale = root.appendChild("scale");
+	scale.appendChild("bScaleX").set(bScaleX);
+	scale.appendChild("bScaleY").set(bScaleY);
+	scale.appendChild("bScaleZ").set(bScaleZ);
+	scale.appendChild("scaleXAmt").set(scaleXAmt);
+	scale.appendChild("scaleYAmt").set(scaleYAmt);
+	scale.appendChild("scaleZAmt").set(scaleZAmt);
+
+	ofXml osc = root.appendChild("osc");
+	osc.appendChild("sendAddress").set(sendAddress);
+	osc.appendChild("sendPort").set(sendPort);
+	osc.appendChild("bBundle").set(bBundle);
+	osc.appendChild("multicastTTL").set(multicastTTL);
+
+	ofXml shmXml = root.appendChild("shm");
+	shmXml.appendChild("bShm").set(bShm);
+	shmXml.appendChild("name").set(shmName);
+
+	ofXml output = root.appendChild("output");
+	output.appendChild("rate").set(outputRate);
+	output.appendChild("bFilter").set(bFilter);
+	output.appendChild("minCutoff").set(filterMinCutoff);
+	output.appendChild("beta").set(filterBeta);
+	output.appendChild("derivativeCutoff").set(filterDerivativeCutoff);
+	output.appendChild("lookahead").set(lookahead);
+
+	ofXml record = root.appendChild("record");
+	record.appendChild("rgb").set(bRecordRGB);
+
+	ofXml statsXml = root.appendChild("stats");
+	statsXml.appendChild("bSendStats").set(bSendStats);
+	statsXml.appendChild("bSendLatency").set(bSendLatency);
+	statsXml.appendChild("bDrawStats").set(bDrawStats);
+	statsXml.appendChild("interval").set(statsInterval);
+
+	if(!xml.save(xmlFile)) {
+		ofLogWarning() << "Couldn't save settings";
+			return false;
+	}
+
+	// save the learned background along with the settings
+	if(bBackground && !core.getBackground().isLearning()) {
+		if(!core.getBackground().save(ofToDataPath(backgroundFile))) {
+			ofLogWarning() << "Couldn't save background: " << core.getBackground().getError();
+		}
+	}
+	return true;
+}
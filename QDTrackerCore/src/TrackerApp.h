@@ -0,0 +1,361 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ * Largely adapted from the Kinect Titty Tracker:
+ * http://danomatika.com/projects/kinect-titty-tracker
+ *
+ */
+#pragma once
+
+#include "ofMain.h"
+
+#include "ofxKinect.h"
+
+#include "TripleBuffer.h"
+#include "DepthStream.h"
+#include "FrameLog.h"
+#include "LatencyStats.h"
+#include "TrackerCore.h"
+#include "OneEuroFilter.h"
+#include "OscPacket.h"
+#include "ShmOutput.h"
+#include "SpscQueue.h"
+#include "UdpSender.h"
+#include "Sensor.h"
+
+#define SETTINGS "settings.xml"
+#define MAX_PERSONS 16 // max number of persons to track
+#define KINECT_FRAME_US 33333 // kinect depth frame period in us, 30 fps
+
+// the kinect tracking app shared by the trackers, which only differ by their
+// estimators: add them in the subclass constructor, each is run on the same
+// blobs & sent to its own osc address
+//
+// tracking runs on its own thread, woken by new kinect depth frames, while
+// the main thread only draws the latest results: settings shared between the
+// two are guarded by the thread mutex
+class TrackerApp : public ofBaseApp, public ofThread {
+
+	public:
+		void setup();
+		void update();
+		void draw();
+		void exit();
+		void keyPressed(int key);
+		
+		void resetSettings();
+		bool loadSettings(const std::string xmlFile=SETTINGS);
+		bool saveSettings(const std::string xmlFile=SETTINGS);
+
+		// start/stop recording depth frames, returns false on error
+		// note: these lock the mutex on their own
+		bool startRecording(const std::string &file);
+		void stopRecording();
+
+		// tracking thread loop
+		void threadedFunction();
+
+		// run the person finder & estimator on the current kinect frame
+		// note: called from the tracking thread with the mutex locked
+		void processFrame();
+
+		// output thread loop, sends each new frame or at the output rate
+		void outputFunction();
+
+		// send each person's position extrapolated to the given time in us
+		// plus the lookahead
+		// note: called from the output thread
+		struct OutputFrame;
+		void sendOutput(const OutputFrame &frame, std::uint64_t now);
+
+		// send latency stats for each pipeline stage
+		// note: called from the output thread
+		void sendStats(const std::vector<LatencyStats::Summary> &summaries);
+
+		// send the current message, unless it's being added to a bundle
+		// note: called from the output thread
+		void sendMessage();
+
+		// set the osc destinations, opened on the output thread
+		void setSender(const std::string &address, unsigned int port, int ttl);
+
+		// open or close the shared memory output by the settings
+		// note: called with the mutex locked
+		void setupShm();
+
+		// merge the persons found here with those found by the additional
+		// sensors in world coordinates, unprojected with the processed depth
+		// frame: returns the number of targets
+		// note: called from the tracking thread with the mutex locked
+		std::size_t fuseSensors(const DepthFrame &frame);
+
+		// add a person's world positions, one per estimator, as a target,
+		// merging it with a target close by on the floor by the primary
+		// position: returns the target index or -1 if there is no room
+		int fuseTarget(const glm::vec3 *positions, std::size_t &count);
+
+		// tracker core settings from the app settings
+		TrackerCore::Settings coreSettings();
+
+		// settings for an additional sensor by kinect id
+		Sensor::Settings sensorSettings(unsigned int kinectID);
+
+		// camera -> world extrinsic transform from a position in mm & euler
+		// rotation in degrees
+		static glm::mat4 sensorTransform(const glm::vec3 &position, const glm::vec3 &rotation);
+
+		// (re)build the raw depth -> grayscale lookup for displaying replayed
+		// frames, mapped the same way as ofxKinect: near white, far black
+		void updateDepthLookup();
+
+	protected:
+
+		// estimator settings in the "tracking" settings section, the reset
+		// may also change the person finder defaults
+		// note: called with the mutex locked
+		virtual void resetEstimatorSettings() {}
+		virtual void loadEstimatorSettings(ofXml &/*tracking*/) {}
+		virtual void saveEstimatorSettings(ofXml &/*tracking*/) {}
+
+		// draw estimator details for a person, ie. the highest point
+		virtual void drawEstimate(const TrackerCore::Person &/*person*/) {}
+
+		// set by the subclass, not owned: the first is the primary, ie. for
+		// fusing sensors, up to MAX_ESTIMATORS
+		std::vector<Estimator*> estimators;
+
+	public:
+
+		ofxKinect kinect;    // our RGB/depth camera of course
+		UdpSender sender;    // for sending positions, used by the output thread
+		OscPacket packet;    // reused for each message by the output thread
+		ShmOutput shm;       // for same-host clients, written by the tracking thread
+		std::vector<std::string> positionAddresses; // per estimator osc address, ie. "/head"
+
+		// display image for replayed frames, converted from raw depth
+		ofPixels depthImage;
+
+		// record & replay
+		DepthRecorder recorder; // records raw depth frames when open
+		DepthPlayer player;     // replays instead of using the kinect when open
+		const unsigned short *rawDepth = nullptr; // current raw depth frame
+		std::vector<std::uint8_t> depthLookup;    // raw depth -> grayscale for display
+		std::atomic<bool> bReplayDone{false};     // replay reached the end?
+
+		// pipeline latency, timed by the tracking thread in TrackerCore::Stage order
+		LatencyStats stats;
+		std::vector<LatencyStats::Summary> statsSummary; // latest summary
+		std::uint64_t statsTime = 0; // last stats summary time in ms
+
+		// capture sequencing, by the tracking thread: live frames missed
+		// between polls show up as gaps in the capture times, replayed ones as
+		// gaps in the recorded sequence
+		std::uint64_t frameSequence = 0;     // capture sequence number, from 1
+		std::uint64_t droppedFrames = 0;     // total frames missed
+		std::uint64_t lastCaptureTime = 0;   // previous capture time in us
+		std::uint32_t lastRecordedSequence = 0; // previous replayed frame sequence
+
+		// person finder, estimator, & tracker
+		TrackerCore core;
+		PersonTracker::Detection detections[MAX_PERSONS]; // fused targets to track
+		int personTargets[MAX_PERSONS]; // tracked target index per person, -1 if none
+		
+		// a tracked & output position: a person found here or, with additional
+		// sensors, a person seen by one or more sensors
+		struct Target {
+			glm::vec3 positions[MAX_ESTIMATORS]; // per estimator output position
+			unsigned int id = 0;  // tracking id, 0 if not tracked
+			unsigned int sensors; // number of sensors that saw this target
+		};
+		Target targets[MAX_PERSONS];
+
+		// additional sensors, fused with the kinect in world coordinates
+		std::vector<std::unique_ptr<Sensor>> sensors;
+
+		// filtered output for a tracked person, owned by the tracking thread
+		struct Output {
+			unsigned int id = 0;     // person id, 0 if unused
+			bool bFound = false;     // found in the last frame?
+			struct Channel {
+				OneEuroFilter x, y, z; // position filters
+				glm::vec3 position;    // last filtered position
+				glm::vec3 velocity;    // filtered velocity in units per second
+			} channels[MAX_ESTIMATORS]; // per estimator
+		};
+		Output outputs[MAX_PERSONS * 2]; // one per track
+
+		// output handed from the tracking thread to the output thread, which
+		// only sends the latest: when sending falls behind, each track's
+		// updates coalesce to its latest position
+		struct OutputFrame {
+			struct Track {
+				unsigned int id = 0;
+				glm::vec3 positions[MAX_ESTIMATORS];  // per estimator
+				glm::vec3 velocities[MAX_ESTIMATORS]; // in units per second
+			} tracks[MAX_PERSONS * 2]; // found tracks
+			std::size_t numTracks = 0;
+			std::uint64_t time = 0;      // frame time in us
+			std::uint64_t timetag = 0;   // frame capture time as an osc timetag
+			std::uint64_t sequence = 0;    // capture sequence number
+			std::uint64_t captureTime = 0; // capture time in us, see FrameLog::now()
+			std::uint64_t dropped = 0;     // total frames dropped
+			bool bBundle = false;        // send as one bundle?
+			bool bSendLatency = false;   // send the frame latency message?
+			std::uint64_t period = 0;    // output period in us, 0 for every frame
+			std::uint64_t lookahead = 0; // extrapolation lookahead in us
+			std::uint64_t statsTime = 0; // stats summary time, sent when it changes
+			std::vector<LatencyStats::Summary> stats; // stats to send
+		};
+		TripleBuffer<OutputFrame> outputFrames; // latest output, lock-free
+		SpscQueue<PersonTracker::Event, MAX_PERSONS * 8> outputEvents; // events to send, in order
+		std::thread outputThread;
+		std::atomic<bool> bOutputRunning{false};
+		std::atomic<bool> bOutputPending{false}; // new output frame or events?
+		std::mutex outputWaitMutex;              // only for waking the output thread
+		std::condition_variable outputCondition;
+
+		// osc destination set by the settings, the sender is (re)opened by the
+		// output thread so resolving the host never holds up tracking
+		std::mutex senderMutex;
+		std::string senderAddress;
+		unsigned int senderPort = 0;
+		int senderTTL = 1;
+		std::atomic<bool> bSenderChanged{false};
+		bool bBundling = false; // adding messages to a bundle? output thread only
+
+		// sent frames, by the output thread & saved on request
+		FrameLog frameLog;
+		std::atomic<bool> bSaveFrameLog{false};
+
+		// live image to display
+		enum DisplayImage {
+			NONE = 0,
+			THRESHOLD = 1,
+			RGB = 2,
+			DEPTH = 3
+		} displayImage;
+
+		// tracking results handed from the tracking thread to draw()
+		struct Result {
+			std::vector<TrackerCore::Person> persons; // found persons, largest first
+			Region region;          // searched region
+			std::vector<LatencyStats::Summary> stats; // latest stage latencies
+			unsigned int threshold = 0; // threshold used for this frame
+			std::uint64_t sequence = 0; // capture sequence number
+			std::uint64_t dropped = 0;  // total frames dropped
+			std::size_t changedTiles = 0, numTiles = 0; // changed tiles when incremental
+			ofPixels image;         // display image, unallocated for NONE
+		};
+		TripleBuffer<Result> results; // latest results, lock-free
+		ofTexture displayTexture;     // display image uploaded in update()
+		
+		// settings
+		unsigned int threshold; // person finder depth threshold in mm, persons are nearer
+		unsigned int nearClipping, farClipping; // kinect clipping planes in mm
+		unsigned int personMinArea, personMaxArea; // min and max area for the person finder
+		unsigned int maxPersons; // max number of persons to find (1-MAX_PERSONS)
+		float trackDistance; // max distance a person moves between frames in pixels
+		unsigned int trackMissedFrames; // frames to keep a lost person before leaving
+		bool bPredictRegion; // only search around tracked persons' predicted positions?
+		unsigned int regionPadding; // padding around each predicted person in pixels
+		unsigned int fullScanFrames; // full frame scan interval in frames when predicting or incremental
+		unsigned int pyramidLevel; // label at 1/2^level size (0-MAX_PYRAMID_LEVEL), refining at full size
+		unsigned int threads; // threads to split each frame across (1-MAX_THREADS)
+
+		// incremental change detection for mostly static scenes
+		bool bIncremental; // only threshold the changed tiles & skip frames where none did?
+		unsigned int changeTolerance; // per pixel depth noise in mm ignored when finding changed tiles
+		unsigned int changeThreshold; // a tile changed when its depth moved by more than this in mm, summed
+
+		// raw depth denoising before thresholding
+		bool bDenoise; // filter the depth?
+		bool bFillHoles; // fill unknown depth from the farther neighbour?
+		unsigned int medianSize; // median size: 0 off, 3 for 3x3, or 5 for 5x5
+		float smoothing; // temporal smoothing 0-1: how much of the last frame to keep, 0 off
+		unsigned int smoothingJump; // depth changes bigger than this in mm aren't smoothed
+
+		// background subtraction
+		bool bBackground; // leave out anything in the learned background?
+		unsigned int backgroundMargin; // persons are nearer than the background by more than this in mm
+		float backgroundRate; // how fast the background adapts in mm per frame, may be below 1
+		unsigned int backgroundLearnFrames; // frames to learn quickly after a reset
+		std::string backgroundFile; // saved background, loaded in setup()
+		
+		// output world coordinates in mm, by the sensor position & rotation,
+		// instead of image coordinates? if so, the normalize options are ignored
+		bool bWorldCoordinates;
+		
+		// normalize the coordinates?
+		bool bNormalizeX; // 0-kinect.width
+		bool bNormalizeY; // 0-kinect.height
+		bool bNormalizeZ; // nearClipping-farClipping
+		
+		// scale coordinates?
+		bool bScaleX, bScaleY, bScaleZ;
+		float scaleXAmt, scaleYAmt, scaleZAmt; // how much to scale
+		
+		// osc send destinations: comma separated host or host:port list, ie.
+		// unicast hosts or a multicast group
+		std::string sendAddress;
+		unsigned int sendPort; // default port
+		bool bBundle;          // send each frame as one bundle?
+		int multicastTTL;      // multicast time to live in hops
+
+		// shared memory output for same-host clients
+		bool bShm;
+		std::string shmName; // shared memory object name, ie. "/qdtracker"
+		
+		unsigned int kinectID; // which kinect to use
+
+		// multiple sensors, world coordinates are in mm
+		struct SensorConfig {
+			unsigned int kinectID; // which kinect to use
+			glm::vec3 position;    // position in world coordinates
+			glm::vec3 rotation;    // euler rotation in degrees
+		};
+		glm::vec3 sensorPosition, sensorRotation; // kinectID world transform
+		std::vector<SensorConfig> sensorConfigs; // additional sensors, opened in setup()
+		float fuseDistance; // merge persons closer than this on the floor in mm
+
+		// run without a window, no textures or drawing, set before setup()
+		bool bHeadless = false;
+
+		// record & replay options, set before setup()
+		std::string recordFile;   // start recording to this file
+		std::string replayFile;   // replay this file instead of using the kinect
+		bool bReplayFast = false; // replay as fast as possible, not real-time
+		bool bReplayLoop = false; // loop replay, otherwise stop at the end
+
+		bool bRecordRGB; // also record RGB frames?
+
+		// output
+		float outputRate; // fixed output rate in Hz, 0 sends on every frame
+		bool bFilter; // filter output positions?
+		float filterMinCutoff; // filter cutoff in Hz when still, lower is smoother
+		float filterBeta; // filter cutoff increase with speed, higher is less lag
+		float filterDerivativeCutoff; // filter cutoff in Hz for the speed
+		float lookahead; // extrapolate output positions ahead in ms
+
+		// latency stats
+		bool bSendStats;     // send stats over osc?
+		bool bSendLatency;   // send each frame's capture to send latency over osc?
+		bool bDrawStats;     // draw stats overlay?
+		float statsInterval; // how often to update stats in seconds
+};
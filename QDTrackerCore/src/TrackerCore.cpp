@@ -0,0 +1,570 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "TrackerCore.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+// region at a pyramid level, rounded out to whole downsampled pixels & clipped
+// to the downsampled frame size
+//--------------------------------------------------------------
+static Region levelRegion(const Region &region, unsigned int level,
+                          std::size_t width, std::size_t height) {
+	int block = 1 << level;
+	Region r;
+	r.x = std::min(region.x >> level, (int)(width >> level));
+	r.y = std::min(region.y >> level, (int)(height >> level));
+	r.width = std::min((region.x + region.width + block - 1) >> level, (int)(width >> level)) - r.x;
+	r.height = std::min((region.y + region.height + block - 1) >> level, (int)(height >> level)) - r.y;
+	return r;
+}
+
+// does the outer region contain the inner one?
+//--------------------------------------------------------------
+static bool containsRegion(const Region &outer, const Region &inner) {
+	return inner.x >= outer.x && inner.y >= outer.y &&
+	       inner.x + inner.width <= outer.x + outer.width &&
+	       inner.y + inner.height <= outer.y + outer.height;
+}
+
+// region grown by padding on each side, clipped to the frame size
+//--------------------------------------------------------------
+static Region padRegion(const Region &region, int padding, std::size_t width, std::size_t height) {
+	Region r;
+	r.x = std::max(region.x - padding, 0);
+	r.y = std::max(region.y - padding, 0);
+	r.width = std::min(region.x + region.width + padding, (int)width) - r.x;
+	r.height = std::min(region.y + region.height + padding, (int)height) - r.y;
+	return r;
+}
+
+//--------------------------------------------------------------
+std::vector<std::string> TrackerCore::stageNames(const Estimator *const *estimators, std::size_t count) {
+	std::string estimate;
+	for(std::size_t i = 0; i < count; ++i) {
+		estimate += (i > 0 ? "+" : "") + std::string(estimators[i]->getName());
+	}
+	return {"grab", "denoise", "threshold", "label", estimate, "track", "filter", "send"};
+}
+
+//--------------------------------------------------------------
+void TrackerCore::setup(std::size_t width, std::size_t height, std::size_t maxPersons) {
+	this->width = width;
+	this->height = height;
+	mask.assign(width * height, 0);
+	maskLevel = 0;
+	for(unsigned int l = 1; l <= MAX_PYRAMID_LEVEL; ++l) {
+		pyramid[l-1].assign((width >> l) * (height >> l), 0);
+		backgroundPyramid[l-1].assign((width >> l) * (height >> l), 0);
+	}
+	background.setup(width, height);
+	denoiser.setup(width, height);
+	tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+	tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+	reference.assign(width * height, 0);
+	changedTiles.assign(tilesX * tilesY, 1);
+	tileDifferences.assign(tilesX * tilesY, 0);
+	thresholdTiles.assign(tilesX * tilesY, 1);
+	numChangedTiles = tilesX * tilesY;
+	bReference = false;
+	resetBackground();
+	personFinder.setup(width, height, maxPersons);
+	tracker.setup(maxPersons * 2); // room for lost persons
+	persons.resize(maxPersons);
+	positions.resize(maxPersons * MAX_ESTIMATORS);
+	detections.resize(maxPersons);
+	numPersons = 0;
+	region = Region();
+	region.width = width;
+	region.height = height;
+	maskRegion = region;
+	transform = selectTransform(settings.transform);
+}
+
+//--------------------------------------------------------------
+void TrackerCore::setEstimators(const Estimator *const *estimators, std::size_t count) {
+	numEstimators = std::min(count, (std::size_t)MAX_ESTIMATORS);
+	bNeedsNearest = false;
+	topBand = 0;
+	for(std::size_t i = 0; i < numEstimators; ++i) {
+		this->estimators[i] = estimators[i];
+		// the labeller finds the top pixel for a single band, so use the widest
+		bNeedsNearest = bNeedsNearest || estimators[i]->getNeedsNearest();
+		topBand = std::max(topBand, estimators[i]->getTopBand());
+	}
+	bReference = false; // the kept blobs were labelled for the last estimators
+}
+
+//--------------------------------------------------------------
+void TrackerCore::setSettings(const Settings &settings) {
+	std::size_t threads = std::max(std::min(settings.threads, (unsigned int)MAX_THREADS), 1u);
+	if(threads != pool.getNumThreads()) {
+		pool.setup(threads);
+	}
+	// the mask of unchanged tiles & the kept blobs are only current for the
+	// same thresholds, denoising, & labelling
+	if(settings.threshold != this->settings.threshold ||
+	   settings.bBackground != this->settings.bBackground ||
+	   settings.backgroundMargin != this->settings.backgroundMargin ||
+	   settings.denoise != this->settings.denoise ||
+	   settings.personMinArea != this->settings.personMinArea ||
+	   settings.personMaxArea != this->settings.personMaxArea ||
+	   settings.maxPersons != this->settings.maxPersons ||
+	   settings.pyramidLevel != this->settings.pyramidLevel) {
+		bReference = false;
+	}
+	this->settings = settings;
+	transform = selectTransform(settings.transform);
+}
+
+//--------------------------------------------------------------
+std::size_t TrackerCore::process(const DepthFrame &input, LatencyStats *stats) {
+
+	// find person-sized blobs, thresholding from the depth frame into the
+	// person finder image in a single pass, only within the search region:
+	// static things are left out when subtracting the background
+	unsigned int level = std::min(settings.pyramidLevel, (unsigned int)MAX_PYRAMID_LEVEL);
+	Region next = searchRegion();
+	if(settings.bIncremental) {
+		// keep the last region while the next one is inside it with some slack,
+		// otherwise move with a tile of slack: a predicted region moves a bit
+		// every frame, which would leave no frame unchanged to skip
+		if(containsRegion(region, next) &&
+		   containsRegion(padRegion(next, 2 * TILE_SIZE, width, height), region)) {
+			next = region;
+		}
+		else {
+			next = padRegion(next, TILE_SIZE, width, height);
+		}
+	}
+	Region nextMask = levelRegion(next, level, width, height);
+	Region lastMask = maskRegion;
+	std::size_t maskStride = width >> level;
+	bool bLevelChanged = (level != maskLevel);
+	bool bRegionChanged = (nextMask.x != maskRegion.x || nextMask.y != maskRegion.y ||
+	                       nextMask.width != maskRegion.width || nextMask.height != maskRegion.height);
+	if(bLevelChanged) {
+		// different mask size, clear it all
+		std::fill(mask.begin(), mask.end(), 0);
+		maskLevel = level;
+		bRegionChanged = true;
+	}
+	else if(bRegionChanged) {
+		// clear the last region so stale blobs aren't found or drawn, only
+		// outside the next region when incremental as the rest is still current
+		for(int y = maskRegion.y; y < maskRegion.y + maskRegion.height; ++y) {
+			std::uint8_t *row = mask.data() + y * maskStride;
+			int x0 = maskRegion.x, x1 = maskRegion.x + maskRegion.width;
+			if(!settings.bIncremental || y < nextMask.y || y >= nextMask.y + nextMask.height) {
+				std::memset(row + x0, 0, x1 - x0);
+				continue;
+			}
+			int left = std::min(x1, nextMask.x), right = std::max(x0, nextMask.x + nextMask.width);
+			if(left > x0) {
+				std::memset(row + x0, 0, left - x0);
+			}
+			if(right < x1) {
+				std::memset(row + right, 0, x1 - right);
+			}
+		}
+	}
+	region = next;
+	maskRegion = nextMask;
+
+	// incremental: only threshold the tiles whose raw depth changed since
+	// they were last thresholded & the tiles the region newly covers, reusing
+	// the last denoised frame & persons when nothing changed, with a full pass
+	// when the mask isn't current & periodically to catch the mask up with
+	// the adapting background & slow drift under the tolerance, change
+	// detection is timed with the denoise stage
+	bool all = true;
+	if(settings.bIncremental) {
+		all = (!bReference || bLevelChanged || framesSinceRefresh >= settings.fullScanFrames ||
+		       (settings.bBackground && background.isLearning()));
+		framesSinceRefresh = (all ? 0 : framesSinceRefresh + 1);
+		findChangedTiles(input, all);
+		if(!all && bRegionChanged) {
+			addUncoveredTiles(lastMask, level);
+		}
+		if(numChangedTiles == 0 && !bRegionChanged) {
+			if(!settings.denoise.isEnabled()) {
+				lastFrame = input; // the same depth, within the tolerance
+			}
+			if(stats) {
+				stats->lap(STAGE_DENOISE);
+			}
+			// the background keeps adapting at its rate, only the mask waits
+			// for a change or the next full pass
+			if(settings.bBackground) {
+				background.update(lastFrame.raw, lastFrame.rawStride, settings.backgroundRate, &pool);
+			}
+			if(stats) {
+				stats->lap(STAGE_THRESHOLD);
+				stats->lap(STAGE_LABEL);
+			}
+			// estimate again from the kept blobs, it's cheap & picks up
+			// estimator & output transform changes
+			estimatePersons(lastFrame);
+			if(stats) {
+				stats->lap(STAGE_ESTIMATE);
+			}
+			return numPersons;
+		}
+	}
+	else {
+		bReference = false;
+		numChangedTiles = tilesX * tilesY;
+	}
+
+	// denoise the raw depth, everything after sees the filtered frame
+	lastFrame = input;
+	lastFrame.raw = denoiser.filter(input.raw, input.rawStride, settings.denoise, &pool);
+	if(lastFrame.raw != input.raw) {
+		lastFrame.rawStride = width;
+	}
+	const DepthFrame &frame = lastFrame;
+	if(stats) {
+		stats->lap(STAGE_DENOISE);
+	}
+
+	// min-reduce the region down to the pyramid level & threshold it, in
+	// bands of rows across the pool
+	std::size_t rows = maskRegion.height, numBands = 1;
+	if(pool.getNumThreads() > 1) {
+		numBands = std::max(std::min(pool.getNumThreads() * BANDS_PER_THREAD, rows / MIN_BAND_ROWS),
+		                    (std::size_t)1);
+	}
+	auto band = [&](std::size_t b) {
+		thresholdRows(frame, level, maskRegion.y + rows * b / numBands,
+		              maskRegion.y + rows * (b + 1) / numBands);
+	};
+	auto tileRow = [&](std::size_t ty) {
+		// the changed tiles in a row, at the mask level & within the region
+		std::size_t tile = TILE_SIZE >> level;
+		std::size_t y0 = std::max(ty * tile, (std::size_t)maskRegion.y);
+		std::size_t y1 = std::min((ty + 1) * tile, (std::size_t)(maskRegion.y + maskRegion.height));
+		for(std::size_t tx = 0; tx < tilesX && y0 < y1; ++tx) {
+			std::size_t x0 = std::max(tx * tile, (std::size_t)maskRegion.x);
+			std::size_t x1 = std::min((tx + 1) * tile, (std::size_t)(maskRegion.x + maskRegion.width));
+			if(thresholdTiles[ty * tilesX + tx] && x0 < x1) {
+				thresholdBlock(frame, level, x0, y0, x1, y1);
+			}
+		}
+	};
+	if(all) {
+		pool.run(numBands, band);
+	}
+	else {
+		pool.run(tilesY, tileRow);
+	}
+	if(settings.bBackground) {
+		background.update(frame.raw, frame.rawStride, settings.backgroundRate, &pool);
+	}
+	if(stats) {
+		stats->lap(STAGE_THRESHOLD);
+	}
+
+	// areas & the top band shrink with the level, blobs are refined back to
+	// full resolution
+	unsigned int areaShift = level * 2;
+	const std::uint16_t *depth = (level > 0 ? pyramid[level-1].data() : frame.raw);
+	std::size_t depthStride = (level > 0 ? maskStride : frame.rawStride);
+	personFinder.label(mask.data(), maskStride,
+	                   bNeedsNearest ? depth : nullptr, depthStride,
+	                   maskRegion, settings.personMinArea >> areaShift, settings.personMaxArea >> areaShift,
+	                   settings.maxPersons, (topBand + (1 << level) - 1) >> level, &pool);
+	numPersons = personFinder.size();
+	for(std::size_t i = 0; i < numPersons; ++i) {
+		persons[i].blob = personFinder[i];
+		if(level > 0) {
+			refineBlob(persons[i].blob, frame, level);
+		}
+	}
+	if(stats) {
+		stats->lap(STAGE_LABEL);
+	}
+
+	estimatePersons(frame);
+	if(stats) {
+		stats->lap(STAGE_ESTIMATE);
+	}
+
+	return numPersons;
+}
+
+//--------------------------------------------------------------
+void TrackerCore::estimatePersons(const DepthFrame &frame) {
+	for(std::size_t i = 0; i < numPersons; ++i) {
+		Person &person = persons[i];
+		person.id = 0;
+		for(std::size_t e = 0; e < numEstimators; ++e) {
+			person.estimates[e] = estimators[e]->estimate(person.blob, frame);
+			positions[i * numEstimators + e] = person.estimates[e];
+		}
+	}
+	if(settings.transform.bWorld && rays.isSetup()) {
+		rays.unproject(positions.data(), numPersons * numEstimators);
+	}
+	transform(positions.data(), numPersons * numEstimators, settings.transform);
+	for(std::size_t i = 0; i < numPersons; ++i) {
+		for(std::size_t e = 0; e < numEstimators; ++e) {
+			persons[i].positions[e] = positions[i * numEstimators + e];
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void TrackerCore::track() {
+	for(std::size_t i = 0; i < numPersons; ++i) {
+		const Blob &blob = persons[i].blob;
+		detections[i].x = blob.centroidX;
+		detections[i].y = blob.centroidY;
+		detections[i].width = blob.width;
+		detections[i].height = blob.height;
+	}
+	track(detections.data(), numPersons);
+	for(std::size_t i = 0; i < numPersons; ++i) {
+		persons[i].id = tracker.getId(i);
+	}
+	bTrackImage = true;
+}
+
+//--------------------------------------------------------------
+void TrackerCore::track(const PersonTracker::Detection *detections, std::size_t count) {
+	tracker.setMaxDistance(settings.trackDistance);
+	tracker.setMaxMissed(settings.trackMissedFrames);
+	tracker.update(detections, count);
+	bTrackImage = false;
+}
+
+//--------------------------------------------------------------
+Region TrackerCore::searchRegion() {
+	Region region;
+	region.width = width;
+	region.height = height;
+
+	// full scan when not predicting, nobody is tracked, any person was lost
+	// (they may be anywhere now), or periodically to find new persons
+	const std::vector<PersonTracker::Track> &tracks = tracker.getTracks();
+	if(!settings.bPredictRegion || !bTrackImage || tracks.empty() ||
+	   framesSinceScan >= settings.fullScanFrames) {
+		framesSinceScan = 0;
+		return region;
+	}
+	float x0 = width, y0 = height, x1 = 0, y1 = 0;
+	for(const PersonTracker::Track &track : tracks) {
+		if(track.missed > 0) {
+			framesSinceScan = 0;
+			return region;
+		}
+		// pad by the predicted movement as well, in case of acceleration
+		float padX = track.width * 0.5 + settings.regionPadding + std::fabs(track.vx);
+		float padY = track.height * 0.5 + settings.regionPadding + std::fabs(track.vy);
+		x0 = std::min(x0, track.predictX() - padX);
+		y0 = std::min(y0, track.predictY() - padY);
+		x1 = std::max(x1, track.predictX() + padX);
+		y1 = std::max(y1, track.predictY() + padY);
+	}
+	framesSinceScan++;
+
+	// union of the padded predictions, clipped to the frame
+	region.x = std::max(0, std::min((int)std::floor(x0), (int)width));
+	region.y = std::max(0, std::min((int)std::floor(y0), (int)height));
+	region.width = std::max(region.x, std::min((int)std::ceil(x1), (int)width)) - region.x;
+	region.height = std::max(region.y, std::min((int)std::ceil(y1), (int)height)) - region.y;
+	return region;
+}
+
+//--------------------------------------------------------------
+void TrackerCore::thresholdBlock(const DepthFrame &frame, unsigned int level,
+                                 std::size_t x0, std::size_t y0, std::size_t x1, std::size_t y1) {
+
+	// min-reduce the block down to the pyramid level, a level at a time
+	const std::uint16_t *depth = frame.raw;
+	const std::uint16_t *back = background.getData();
+	std::size_t depthStride = frame.rawStride, backStride = width;
+	for(unsigned int l = 1; l <= level; ++l) {
+		std::size_t stride = width >> l;
+		std::size_t x = x0 << (level - l), y = y0 << (level - l);
+		std::size_t w = (x1 - x0) << (level - l), h = (y1 - y0) << (level - l);
+		downsampleDepth(depth + (y * 2) * depthStride + x * 2, depthStride,
+		                pyramid[l-1].data() + y * stride + x, stride, w, h);
+		depth = pyramid[l-1].data();
+		depthStride = stride;
+		if(settings.bBackground) {
+			downsampleDepth(back + (y * 2) * backStride + x * 2, backStride,
+			                backgroundPyramid[l-1].data() + y * stride + x, stride, w, h);
+			back = backgroundPyramid[l-1].data();
+			backStride = stride;
+		}
+	}
+
+	std::size_t maskStride = width >> level;
+	std::uint16_t threshold = std::min(settings.threshold, 0xFFFFu);
+	if(settings.bBackground) {
+		thresholdForeground(depth + y0 * depthStride + x0, depthStride,
+		                    back + y0 * backStride + x0, backStride,
+		                    mask.data() + y0 * maskStride + x0, maskStride,
+		                    x1 - x0, y1 - y0, threshold,
+		                    std::min(settings.backgroundMargin, 0xFFFFu));
+	}
+	else {
+		thresholdDepth(depth + y0 * depthStride + x0, depthStride,
+		               mask.data() + y0 * maskStride + x0, maskStride,
+		               x1 - x0, y1 - y0, threshold);
+	}
+}
+
+//--------------------------------------------------------------
+void TrackerCore::findChangedTiles(const DepthFrame &frame, bool all) {
+	std::uint16_t tolerance = std::min(settings.changeTolerance, 0xFFFFu);
+	auto tileRow = [&](std::size_t ty) {
+		std::size_t y = ty * TILE_SIZE, h = std::min(TILE_SIZE, height - y);
+		std::uint32_t *differences = tileDifferences.data() + ty * tilesX;
+		if(!all) {
+			// every few rows, as this is memory bound & persons span many
+			differenceTiles(frame.raw + y * frame.rawStride, frame.rawStride * CHANGE_ROW_STEP,
+			                reference.data() + y * width, width * CHANGE_ROW_STEP,
+			                width, (h + CHANGE_ROW_STEP - 1) / CHANGE_ROW_STEP, tolerance, differences);
+		}
+		for(std::size_t tx = 0; tx < tilesX; ++tx) {
+			std::size_t x = tx * TILE_SIZE, w = std::min(TILE_SIZE, width - x);
+			const std::uint16_t *depth = frame.raw + y * frame.rawStride + x;
+			std::uint16_t *ref = reference.data() + y * width + x;
+			bool changed = all || differences[tx] > settings.changeThreshold;
+			changedTiles[ty * tilesX + tx] = changed;
+			if(changed) {
+				for(std::size_t row = 0; row < h; ++row) {
+					std::memcpy(ref + row * width, depth + row * frame.rawStride, w * sizeof(std::uint16_t));
+				}
+			}
+		}
+	};
+	pool.run(tilesY, tileRow);
+	numChangedTiles = std::count(changedTiles.begin(), changedTiles.end(), 1);
+	bReference = true;
+
+	// threshold the changed tiles & their neighbours, as only every few rows
+	// are compared: a change in the rows between spreads to the tiles around
+	// it, ie. the top of a head moving up into a tile is seen by its sides
+	for(std::size_t ty = 0; ty < tilesY; ++ty) {
+		for(std::size_t tx = 0; tx < tilesX; ++tx) {
+			bool changed = false;
+			for(std::size_t y = (ty > 0 ? ty - 1 : 0); y <= ty + 1 && y < tilesY; ++y) {
+				for(std::size_t x = (tx > 0 ? tx - 1 : 0); x <= tx + 1 && x < tilesX; ++x) {
+					changed = changed || changedTiles[y * tilesX + x];
+				}
+			}
+			thresholdTiles[ty * tilesX + tx] = changed;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void TrackerCore::addUncoveredTiles(const Region &last, unsigned int level) {
+	// the tiles with part of the region outside the last one, in mask pixels
+	int tile = TILE_SIZE >> level;
+	for(std::size_t ty = 0; ty < tilesY; ++ty) {
+		for(std::size_t tx = 0; tx < tilesX; ++tx) {
+			Region r;
+			r.x = std::max((int)tx * tile, maskRegion.x);
+			r.y = std::max((int)ty * tile, maskRegion.y);
+			r.width = std::min(((int)tx + 1) * tile, maskRegion.x + maskRegion.width) - r.x;
+			r.height = std::min(((int)ty + 1) * tile, maskRegion.y + maskRegion.height) - r.y;
+			if(r.width > 0 && r.height > 0 && !containsRegion(last, r)) {
+				thresholdTiles[ty * tilesX + tx] = 1;
+				numChangedTiles += !changedTiles[ty * tilesX + tx];
+				changedTiles[ty * tilesX + tx] = 1;
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void TrackerCore::refineBlob(Blob &blob, const DepthFrame &frame, unsigned int level) const {
+	int block = 1 << level;
+	blob.area <<= level * 2;
+	blob.centroidX = (blob.centroidX + 0.5f) * block - 0.5f;
+	blob.centroidY = (blob.centroidY + 0.5f) * block - 0.5f;
+	blob.x <<= level;
+	blob.y <<= level;
+	blob.width <<= level;
+	blob.height <<= level;
+
+	// each downsampled depth is the nearest of the 2x2 block below it, so
+	// descend the pyramid to the full size pixel a level at a time: a max
+	// of 4 reads per level instead of rescanning the whole block
+	if(blob.nearestY >= 0) {
+		int x = blob.nearestX, y = blob.nearestY;
+		for(int l = (int)level - 1; l >= 0; --l) {
+			const std::uint16_t *depth = (l == 0 ? frame.raw : pyramid[l-1].data());
+			std::size_t stride = (l == 0 ? frame.rawStride : width >> l);
+			x *= 2;
+			y *= 2;
+			const std::uint16_t *quad = depth + y * stride + x;
+			if(quad[0] == blob.nearestDepth) {
+				continue;
+			}
+			if(quad[1] == blob.nearestDepth) {
+				x += 1;
+			}
+			else if(quad[stride] == blob.nearestDepth) {
+				y += 1;
+			}
+			else {
+				x += 1;
+				y += 1;
+			}
+		}
+		blob.nearestX = x;
+		blob.nearestY = y;
+	}
+
+	// the first row in the top block with any foreground within the band,
+	// otherwise the middle of the block
+	if(blob.topY >= 0) {
+		int y0 = blob.topY << level;
+		int lo = std::max(blob.x, (int)std::floor(blob.centroidX - topBand) + 1);
+		int hi = std::min(blob.x + blob.width - 1, (int)std::ceil(blob.centroidX + topBand) - 1);
+		const std::uint16_t *back = background.getData();
+		blob.topX = (blob.topX << level) + block / 2;
+		blob.topY = y0 + block / 2;
+		for(int y = y0; y < y0 + block; ++y) {
+			int first = -1, last = -1;
+			for(int x = lo; x <= hi; ++x) {
+				std::uint16_t d = frame.raw[y * frame.rawStride + x];
+				std::uint16_t b = back[y * width + x];
+				if(d != 0 && d < settings.threshold &&
+				   (!settings.bBackground || b == 0 || d + settings.backgroundMargin < b)) {
+					first = (first < 0 ? x : first);
+					last = x;
+				}
+			}
+			if(first >= 0) {
+				blob.topX = (first + last) / 2;
+				blob.topY = y;
+				break;
+			}
+		}
+	}
+}
@@ -0,0 +1,259 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Estimator.h"
+#include "Transform.h"
+#include "DepthRays.h"
+#include "DepthFilter.h"
+#include "DepthKernels.h"
+#include "BlobLabeller.h"
+#include "BackgroundModel.h"
+#include "PersonTracker.h"
+#include "LatencyStats.h"
+#include "ThreadPool.h"
+
+#define MAX_ESTIMATORS 2 // max number of estimators run on the same blobs
+#define MAX_PYRAMID_LEVEL 2 // max downsampling level to label at, 1/4 size
+#define MAX_THREADS 64 // max number of threads to split a frame across
+
+// the per-frame person tracking pipeline, without the camera or output:
+// subtracts the learned background, thresholds & labels a depth frame,
+// estimates each person's position with one or more pluggable estimators,
+// transforms the positions for output, & tracks ids
+//
+// blobs can be labelled at a downsampled level of a min-reduced depth pyramid,
+// then only their top & nearest points are refined at full resolution
+//
+// the threshold & label stages can be split into bands of rows on a thread
+// pool, the calling thread included
+//
+// all storage is sized by setup(), so processing never allocates
+class TrackerCore {
+
+	public:
+
+		// pipeline stages for latency stats, grab, filter, & send are the app's
+		enum Stage {
+			STAGE_GRAB = 0,  // grab depth frame
+			STAGE_DENOISE,   // filter the raw depth frame, when enabled
+			STAGE_THRESHOLD, // threshold straight from the raw depth frame
+			STAGE_LABEL,     // find person blobs
+			STAGE_ESTIMATE,  // estimator position search
+			STAGE_TRACK,     // match persons to tracks
+			STAGE_FILTER,    // filter positions for output
+			STAGE_SEND       // hand off to the output thread
+		};
+
+		// stage names for LatencyStats::setup(), in Stage order, the estimate
+		// stage is named after the estimators, ie. "head+overhead"
+		static std::vector<std::string> stageNames(const Estimator *const *estimators, std::size_t count);
+		static std::vector<std::string> stageNames(const Estimator &estimator) {
+			const Estimator *e = &estimator;
+			return stageNames(&e, 1);
+		}
+
+		struct Settings {
+			unsigned int threshold = 1800; // person finder depth threshold in mm, persons are nearer
+			unsigned int personMinArea = 3000, personMaxArea = 153600; // min and max area for the person finder
+			unsigned int maxPersons = 4; // max number of persons to find, up to the setup() max
+			float trackDistance = 100; // max distance a person moves between frames
+			unsigned int trackMissedFrames = 10; // frames to keep a lost person before leaving
+			bool bPredictRegion = false; // only search around tracked persons' predicted positions?
+			unsigned int regionPadding = 40; // padding around each predicted person in pixels
+			unsigned int fullScanFrames = 30; // full frame scan interval in frames when predicting or incremental
+			bool bBackground = false; // subtract the learned background before thresholding?
+			unsigned int backgroundMargin = 100; // foreground is nearer than the background by more than this in mm
+			float backgroundRate = 0.1; // background adapt rate in mm per frame, may be below 1
+			unsigned int backgroundLearnFrames = 90; // frames to learn quickly after a background reset
+			unsigned int pyramidLevel = 0; // label at 1/2^level size: 0 full, 1 half, 2 quarter
+			unsigned int threads = 1; // threads to split a frame across, 1 for the calling thread only
+			DepthFilter::Settings denoise; // raw depth denoising before thresholding
+			bool bIncremental = false; // only threshold the tiles that changed & skip frames where none did?
+			unsigned int changeTolerance = 30; // per pixel depth noise in mm ignored when finding changed tiles
+			unsigned int changeThreshold = 4096; // a tile changed when its depth moved by more than this in mm, summed
+			Transform transform; // output normalize & scale
+		};
+
+		// found person
+		struct Person {
+			unsigned int id = 0; // persistent tracking id, 0 if not tracked
+			Blob blob;           // person blob
+			Position estimates[MAX_ESTIMATORS]; // per estimator position in image coordinates & mm
+			Position positions[MAX_ESTIMATORS]; // per estimator output position after unproject, normalize, & scale
+		};
+
+		// allocate for the frame size & max number of persons
+		void setup(std::size_t width, std::size_t height, std::size_t maxPersons);
+
+		// set the estimator, not owned
+		void setEstimator(const Estimator *estimator) {setEstimators(&estimator, 1);}
+
+		// set several estimators run on the same blobs, up to MAX_ESTIMATORS,
+		// not owned: the first is the primary, ie. for fusing sensors
+		void setEstimators(const Estimator *const *estimators, std::size_t count);
+		std::size_t getNumEstimators() const {return numEstimators;}
+		const Estimator* getEstimator(std::size_t i=0) const {return estimators[i];}
+
+		void setSettings(const Settings &settings);
+		const Settings& getSettings() const {return settings;}
+
+		// denoise, threshold, label, estimate, & transform the persons in a
+		// frame, within the predicted search region when enabled & tracking by
+		// image position: when incremental, only the changed tiles are
+		// thresholded & the last blobs are kept if nothing changed
+		//
+		// laps the denoise, threshold, label, & estimate stages if stats is non-null
+		// returns the number of persons found, largest first
+		std::size_t process(const DepthFrame &frame, LatencyStats *stats=nullptr);
+
+		// track the persons found by process() by their image centroids
+		void track();
+
+		// track other detections, ie. persons fused from several sensors: the
+		// predicted search region is not used as the tracks aren't in the image
+		// note: person ids are not set
+		void track(const PersonTracker::Detection *detections, std::size_t count);
+
+		std::size_t size() const {return numPersons;}
+		Person& operator[](std::size_t i) {return persons[i];}
+		const Person& operator[](std::size_t i) const {return persons[i];}
+
+		const PersonTracker& getTracker() const {return tracker;}
+
+		// learned background, only updated when enabled
+		BackgroundModel& getBackground() {return background;}
+
+		// forget the background & learn it again
+		void resetBackground() {
+			background.reset(settings.backgroundLearnFrames);
+			bReference = false;
+		}
+
+		// last searched region
+		const Region& getRegion() const {return region;}
+
+		// tiles thresholded again by the last process() when incremental, all of
+		// them when not: 0 means the frame was skipped & the persons are cached
+		std::size_t getNumChangedTiles() const {return numChangedTiles;}
+		std::size_t getNumTiles() const {return tilesX * tilesY;}
+		static const std::size_t TILE_SIZE = DEPTHKERNELS_TILE_SIZE; // change detection tile size in pixels
+
+		// thresholded person finder image, only current within the region &
+		// downsampled to the pyramid level
+		const std::uint8_t* getMask() const {return mask.data();}
+		std::size_t getMaskWidth() const {return width >> maskLevel;}
+		std::size_t getMaskHeight() const {return height >> maskLevel;}
+
+		std::size_t getWidth() const {return width;}
+		std::size_t getHeight() const {return height;}
+
+		// last processed depth frame, denoised when enabled: only current until
+		// the next process() as it may point into the frame passed in
+		const DepthFrame& getFrame() const {return lastFrame;}
+
+		// camera rays for world coordinates, set up from the camera intrinsics
+		// before enabling Transform::bWorld
+		DepthRays& getRays() {return rays;}
+		const DepthRays& getRays() const {return rays;}
+
+	private:
+
+		// region to search this frame: padded around the tracked persons'
+		// predicted positions or the full frame for a periodic full scan
+		Region searchRegion();
+
+		// downsample & threshold the mask rows [y0, y1) within the region
+		void thresholdRows(const DepthFrame &frame, unsigned int level, std::size_t y0, std::size_t y1) {
+			thresholdBlock(frame, level, maskRegion.x, y0, maskRegion.x + maskRegion.width, y1);
+		}
+
+		// downsample & threshold the mask block [x0, x1) x [y0, y1), in mask
+		// level pixels
+		void thresholdBlock(const DepthFrame &frame, unsigned int level,
+		                    std::size_t x0, std::size_t y0, std::size_t x1, std::size_t y1);
+
+		// estimate each person's positions from the same blob, then unproject,
+		// normalize, & scale them all at once
+		void estimatePersons(const DepthFrame &frame);
+
+		// compare the frame to the reference depth per tile, marking the tiles
+		// that changed & updating their reference: all of them if all is set
+		void findChangedTiles(const DepthFrame &frame, bool all);
+
+		// also threshold the tiles of the region that the last region, in mask
+		// level pixels, didn't cover, counted as changed
+		void addUncoveredTiles(const Region &last, unsigned int level);
+
+		// refine a blob labelled at the pyramid level to full resolution: the
+		// nearest point descends the pyramid & the top point is searched again
+		// in the full frame, only within the pixel block it was found in
+		void refineBlob(Blob &blob, const DepthFrame &frame, unsigned int level) const;
+
+		std::size_t width = 0, height = 0;
+		const Estimator *estimators[MAX_ESTIMATORS] = {nullptr};
+		std::size_t numEstimators = 0;
+		bool bNeedsNearest = false; // labeller options for all estimators
+		int topBand = 0;
+		Settings settings;
+		TransformFunction transform = nullptr;
+		DepthRays rays;
+		DepthFilter denoiser;
+		DepthFrame lastFrame; // last processed
+		ThreadPool pool;
+
+		static const std::size_t BANDS_PER_THREAD = 4; // for stealing
+		static const std::size_t CHANGE_ROW_STEP = 4; // tile rows compared for change detection
+		static const std::size_t MIN_BAND_ROWS = 8;
+
+		std::vector<std::uint8_t> mask;
+		unsigned int maskLevel = 0; // pyramid level of the mask
+		std::vector<std::uint16_t> pyramid[MAX_PYRAMID_LEVEL]; // downsampled depth per level
+		std::vector<std::uint16_t> backgroundPyramid[MAX_PYRAMID_LEVEL];
+		BackgroundModel background;
+		BlobLabeller personFinder;
+		PersonTracker tracker; // persistent person ids
+		std::vector<Person> persons;
+		std::vector<Position> positions; // for transforming, per person & estimator
+		std::vector<PersonTracker::Detection> detections;
+		std::size_t numPersons = 0;
+
+		Region region;                    // last searched region
+		Region maskRegion;                // last searched region at the mask level
+		bool bTrackImage = false;         // tracking by image position?
+		unsigned int framesSinceScan = 0; // frames since the last full scan
+
+		// incremental change detection
+		std::vector<std::uint16_t> reference; // depth each tile was last thresholded with
+		std::vector<std::uint8_t> changedTiles; // 1 if changed, per tile in row order
+		std::vector<std::uint32_t> tileDifferences; // per tile in row order
+		std::vector<std::uint8_t> thresholdTiles; // changed tiles & their neighbours
+		std::size_t tilesX = 0, tilesY = 0;
+		std::size_t numChangedTiles = 0;
+		bool bReference = false; // reference matches the mask?
+		unsigned int framesSinceRefresh = 0; // frames since all tiles were thresholded
+};
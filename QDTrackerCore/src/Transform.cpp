@@ -0,0 +1,85 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "Transform.h"
+
+enum TransformFlags {
+	NORMALIZE_X = 1 << 0,
+	NORMALIZE_Y = 1 << 1,
+	NORMALIZE_Z = 1 << 2,
+	SCALE_X     = 1 << 3,
+	SCALE_Y     = 1 << 4,
+	SCALE_Z     = 1 << 5,
+	WORLD       = 1 << 6
+};
+
+// FLAGS is a compile time constant, so the unused branches are compiled out
+template<unsigned int FLAGS>
+static void transformPositions(Position *positions, std::size_t count, const Transform &transform) {
+	const float depthRange = transform.depthFar - transform.depthNear;
+	for(std::size_t i = 0; i < count; ++i) {
+		Position &p = positions[i];
+
+		// camera -> world, unknown (0) depth stays 0, 0, 0
+		if((FLAGS & WORLD) && p.z > 0) {
+			const float *m = transform.world;
+			float x = m[0] * p.x + m[1] * p.y + m[2]  * p.z + m[3];
+			float y = m[4] * p.x + m[5] * p.y + m[6]  * p.z + m[7];
+			float z = m[8] * p.x + m[9] * p.y + m[10] * p.z + m[11];
+			p.x = x;
+			p.y = y;
+			p.z = z;
+		}
+
+		// normalize values
+		if(FLAGS & NORMALIZE_X) p.x = p.x / transform.width;
+		if(FLAGS & NORMALIZE_Y) p.y = p.y / transform.height;
+		if(FLAGS & NORMALIZE_Z) p.z = (p.z - transform.depthNear) / depthRange;
+
+		// scale values
+		if(FLAGS & SCALE_X) p.x *= transform.scaleXAmt;
+		if(FLAGS & SCALE_Y) p.y *= transform.scaleYAmt;
+		if(FLAGS & SCALE_Z) p.z *= transform.scaleZAmt;
+	}
+}
+
+// every combination, indexed by flags
+#define TRANSFORMS_4(n) transformPositions<n>, transformPositions<n+1>, \
+                        transformPositions<n+2>, transformPositions<n+3>
+#define TRANSFORMS_16(n) TRANSFORMS_4(n), TRANSFORMS_4(n+4), \
+                         TRANSFORMS_4(n+8), TRANSFORMS_4(n+12)
+static const TransformFunction transforms[128] = {
+	TRANSFORMS_16(0), TRANSFORMS_16(16), TRANSFORMS_16(32), TRANSFORMS_16(48),
+	TRANSFORMS_16(64), TRANSFORMS_16(80), TRANSFORMS_16(96), TRANSFORMS_16(112)
+};
+
+//--------------------------------------------------------------
+TransformFunction selectTransform(const Transform &transform) {
+	bool bNormalize = !transform.bWorld;
+	unsigned int flags = (transform.bWorld ? WORLD : 0) |
+	                     (bNormalize && transform.bNormalizeX ? NORMALIZE_X : 0) |
+	                     (bNormalize && transform.bNormalizeY ? NORMALIZE_Y : 0) |
+	                     (bNormalize && transform.bNormalizeZ ? NORMALIZE_Z : 0) |
+	                     (transform.bScaleX ? SCALE_X : 0) |
+	                     (transform.bScaleY ? SCALE_Y : 0) |
+	                     (transform.bScaleZ ? SCALE_Z : 0);
+	return transforms[flags];
+}
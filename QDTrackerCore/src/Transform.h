@@ -0,0 +1,61 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include <cstddef>
+
+#include "Estimator.h"
+
+// output position normalize & scale options
+struct Transform {
+
+	// positions are camera coordinates in mm, see DepthRays? if so, they're
+	// moved into world coordinates by the camera -> world transform & the
+	// normalize options are ignored as they're for image coordinates
+	bool bWorld = false;
+
+	// camera -> world extrinsic transform: row major 3x4 rotation & translation
+	// in mm, identity by default
+	float world[12] = {1, 0, 0, 0,
+	                   0, 1, 0, 0,
+	                   0, 0, 1, 0};
+
+	// normalize the coordinates?
+	bool bNormalizeX = false; // 0-width
+	bool bNormalizeY = false; // 0-height
+	bool bNormalizeZ = false; // depthNear-depthFar
+
+	// scale the coordinates?
+	bool bScaleX = false, bScaleY = false, bScaleZ = false;
+	float scaleXAmt = 1, scaleYAmt = 1, scaleZAmt = 1; // how much to scale
+
+	// normalize ranges
+	float width = 640, height = 480;
+	float depthNear = 500, depthFar = 4000; // mm
+};
+
+// transforms positions in place
+typedef void (*TransformFunction)(Position *positions, std::size_t count, const Transform &transform);
+
+// transform function specialised at compile time for the enabled options, so
+// no options are checked per position: select again when the options change
+TransformFunction selectTransform(const Transform &transform);
@@ -0,0 +1,69 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// lock-free single producer / single consumer latest-value buffer
+//
+// the writer fills back() and calls publish(), the reader calls update() and
+// reads front(), neither side ever waits on the other: the writer always has
+// a free slot and the reader always sees the most recently published value
+template<typename T>
+class TripleBuffer {
+
+	public:
+
+		TripleBuffer() : middle(2) {}
+
+		// writer: slot to fill before publishing
+		T& back() {return buffers[backIndex];}
+
+		// writer: hand the back slot to the reader, swapping in the middle slot
+		void publish() {
+			backIndex = middle.exchange(backIndex | FRESH, std::memory_order_acq_rel) & INDEX;
+		}
+
+		// reader: grab the latest published slot, returns true if it is new
+		bool update() {
+			if(!(middle.load(std::memory_order_acquire) & FRESH)) {
+				return false;
+			}
+			frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & INDEX;
+			return true;
+		}
+
+		// reader: latest published value
+		T& front() {return buffers[frontIndex];}
+		const T& front() const {return buffers[frontIndex];}
+
+	private:
+
+		static const std::uint8_t INDEX = 0x3; // slot index bits
+		static const std::uint8_t FRESH = 0x4; // middle slot has unread data
+
+		T buffers[3];
+		std::atomic<std::uint8_t> middle; // shared slot index & fresh flag
+		std::uint8_t backIndex = 0;       // owned by the writer
+		std::uint8_t frontIndex = 1;      // owned by the reader
+};
@@ -0,0 +1,168 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#include "UdpSender.h"
+
+#include <cerrno>
+#include <cstring>
+
+#if defined(_WIN32)
+	#include <winsock2.h>
+	#include <ws2tcpip.h>
+	#define CLOSE_SOCKET closesocket
+#else
+	#include <netdb.h>
+	#include <netinet/in.h>
+	#include <sys/socket.h>
+	#include <unistd.h>
+	#define CLOSE_SOCKET ::close
+#endif
+
+//--------------------------------------------------------------
+bool UdpSender::setup(const std::string &hosts, unsigned int port, int ttl) {
+	close();
+#if defined(_WIN32)
+	static bool bStarted = false;
+	if(!bStarted) {
+		WSADATA wsa;
+		WSAStartup(MAKEWORD(2, 2), &wsa);
+		bStarted = true;
+	}
+#endif
+	error.clear();
+	std::size_t pos = 0;
+	while(pos < hosts.size()) {
+		std::size_t end = hosts.find(',', pos);
+		if(end == std::string::npos) {
+			end = hosts.size();
+		}
+		std::size_t first = hosts.find_first_not_of(" \t", pos);
+		std::size_t last = hosts.find_last_not_of(" \t", end - 1);
+		pos = end + 1;
+		if(first >= end || last == std::string::npos || last < first) {
+			continue; // empty
+		}
+		std::string host = hosts.substr(first, last - first + 1);
+
+		// split off the port: host:port or [ipv6]:port, a bare ipv6 address
+		// has more than one colon
+		std::string service = std::to_string(port);
+		std::size_t colon = host.rfind(':');
+		if(host[0] == '[') {
+			std::size_t bracket = host.find(']');
+			if(bracket != std::string::npos) {
+				if(colon != std::string::npos && colon > bracket) {
+					service = host.substr(colon + 1);
+				}
+				host = host.substr(1, bracket - 1);
+			}
+		}
+		else if(colon != std::string::npos && host.find(':') == colon) {
+			service = host.substr(colon + 1);
+			host = host.substr(0, colon);
+		}
+
+		if(numTargets == UDPSENDER_MAX_TARGETS) {
+			error = "too many destinations, max " + std::to_string(UDPSENDER_MAX_TARGETS);
+			break;
+		}
+		addTarget(host, service, ttl);
+	}
+	if(numTargets == 0 && error.empty()) {
+		error = "no destinations";
+	}
+	return error.empty();
+}
+
+//--------------------------------------------------------------
+void UdpSender::close() {
+	for(std::size_t i = 0; i < numTargets; ++i) {
+		CLOSE_SOCKET(targets[i].sock);
+		targets[i].sock = -1;
+	}
+	numTargets = 0;
+}
+
+//--------------------------------------------------------------
+bool UdpSender::send(const void *data, std::size_t size) {
+	bool ok = (numTargets > 0);
+	for(std::size_t i = 0; i < numTargets; ++i) {
+		const Target &target = targets[i];
+		if(sendto(target.sock, (const char *)data, size, 0,
+		          (const sockaddr *)target.address, target.addressLength) != (long)size) {
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+//--------------------------------------------------------------
+bool UdpSender::addTarget(const std::string &host, const std::string &port, int ttl) {
+	static_assert(sizeof(Target::address) >= sizeof(sockaddr_storage), "address too small");
+
+	// keep the first error, but carry on with the other destinations
+	addrinfo hints;
+	std::memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_DGRAM;
+	addrinfo *info = nullptr;
+	int ret = getaddrinfo(host.c_str(), port.c_str(), &hints, &info);
+	if(ret != 0 || !info) {
+		if(error.empty()) {
+			error = "couldn't resolve " + host + ": " + gai_strerror(ret);
+		}
+		return false;
+	}
+	long long s = (long long)socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+	if(s < 0) {
+		if(error.empty()) {
+			error = "couldn't open socket: " + std::string(std::strerror(errno));
+		}
+		freeaddrinfo(info);
+		return false;
+	}
+	int broadcast = 1;
+	setsockopt(s, SOL_SOCKET, SO_BROADCAST, (const char *)&broadcast, sizeof(broadcast));
+
+	// multicast group?
+	int loop = 1;
+	if(info->ai_family == AF_INET) {
+		const sockaddr_in *in = (const sockaddr_in *)info->ai_addr;
+		if((ntohl(in->sin_addr.s_addr) >> 28) == 0xE) { // 224.0.0.0/4
+			setsockopt(s, IPPROTO_IP, IP_MULTICAST_TTL, (const char *)&ttl, sizeof(ttl));
+			setsockopt(s, IPPROTO_IP, IP_MULTICAST_LOOP, (const char *)&loop, sizeof(loop));
+		}
+	}
+	else if(info->ai_family == AF_INET6) {
+		const sockaddr_in6 *in6 = (const sockaddr_in6 *)info->ai_addr;
+		if(IN6_IS_ADDR_MULTICAST(&in6->sin6_addr)) {
+			setsockopt(s, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, (const char *)&ttl, sizeof(ttl));
+			setsockopt(s, IPPROTO_IPV6, IPV6_MULTICAST_LOOP, (const char *)&loop, sizeof(loop));
+		}
+	}
+
+	Target &target = targets[numTargets++];
+	std::memcpy(target.address, info->ai_addr, info->ai_addrlen);
+	target.addressLength = info->ai_addrlen;
+	target.sock = s;
+	freeaddrinfo(info);
+	return true;
+}
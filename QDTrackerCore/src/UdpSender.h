@@ -0,0 +1,71 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#define UDPSENDER_MAX_TARGETS 8 // max number of destinations
+
+// sends UDP datagrams to one or more hosts, ie. encoded OSC packets
+//
+// the hosts are resolved in setup(), so sending never allocates, broadcast
+// & multicast group addresses are allowed
+class UdpSender {
+
+	public:
+
+		~UdpSender() {close();}
+
+		// resolve hosts & open a socket for each, returns false on error
+		//
+		// hosts is a comma separated list of host or host:port destinations,
+		// using the given port if not set, ie. "127.0.0.1, 192.168.1.20:9001",
+		// IPv6 addresses with a port are bracketed: "[::1]:9001"
+		//
+		// ttl is the multicast time to live in hops, 1 stays on the local
+		// network: multicast is looped back so local receivers also get it
+		bool setup(const std::string &hosts, unsigned int port, int ttl=1);
+		void close();
+
+		bool isOpen() const {return numTargets > 0;}
+		std::size_t getNumTargets() const {return numTargets;}
+
+		// send a datagram to every destination, returns false on error
+		bool send(const void *data, std::size_t size);
+
+		const std::string& getError() const {return error;}
+
+	private:
+
+		// resolve a host & open its socket, returns false on error
+		bool addTarget(const std::string &host, const std::string &port, int ttl);
+
+		struct Target {
+			long long sock = -1;             // socket handle
+			std::uint8_t address[128] = {0}; // destination sockaddr
+			std::size_t addressLength = 0;
+		} targets[UDPSENDER_MAX_TARGETS];
+		std::size_t numTargets = 0;
+		std::string error;
+};
@@ -0,0 +1,177 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+#ifndef QDTSHM_H
+#define QDTSHM_H
+
+// shared memory output ring layout & reader for same-host clients, plain C
+//
+// the tracker writes each frame's tracks into the next slot of a ring in a
+// POSIX shared memory object, ie. "/qdtracker", & clients poll the latest
+// frame straight from the mapping: no syscalls after opening & no decoding
+//
+//     qdtshm_reader reader;
+//     qdtshm_frame frame;
+//     if(qdtshm_open(&reader, "/qdtracker") == 0) {
+//         while(running) {
+//             if(qdtshm_read(&reader, &frame) == 1) {
+//                 // frame.tracks[0 to frame.numTracks - 1]
+//             }
+//         }
+//         qdtshm_close(&reader);
+//     }
+//
+// each slot is guarded by a seqlock: its sequence is odd while being written,
+// so a reader copies the slot & retries if the sequence changed meanwhile,
+// the writer never waits on readers
+//
+// the object is left in place when the tracker quits, so readers survive a
+// restart: a stale reader just sees no new frames
+//
+// note: uses POSIX shared memory & GCC/Clang atomic builtins, so macOS &
+// Linux only for now, link with -lrt on Linux before glibc 2.34
+
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define QDTSHM_MAGIC "QDTS"
+#define QDTSHM_VERSION 1
+#define QDTSHM_RING_SIZE 8       // frames in the ring
+#define QDTSHM_MAX_TRACKS 32     // max tracks per frame
+#define QDTSHM_MAX_ESTIMATORS 2  // max positions per track
+#define QDTSHM_NAME_SIZE 16      // estimator name size, including the 0
+
+// a tracked person
+typedef struct {
+	uint32_t id;        // persistent tracking id, starting at 1
+	uint32_t reserved;
+	float positions[QDTSHM_MAX_ESTIMATORS][3]; // x y z per estimator, as sent over osc
+} qdtshm_track;
+
+// a frame's tracks
+typedef struct {
+	uint64_t sequence;  // seqlock sequence, odd while being written
+	uint64_t frame;     // frame number, starting at 1
+	uint64_t timestamp; // frame capture time in us since the unix epoch
+	uint32_t numTracks; // number of tracks
+	uint32_t reserved;
+	qdtshm_track tracks[QDTSHM_MAX_TRACKS];
+} qdtshm_frame;
+
+// shared memory object layout
+typedef struct {
+	char magic[4];          // QDTSHM_MAGIC
+	uint32_t version;       // QDTSHM_VERSION
+	uint32_t ringSize;      // QDTSHM_RING_SIZE
+	uint32_t maxTracks;     // QDTSHM_MAX_TRACKS
+	uint32_t numEstimators; // positions used per track
+	uint32_t reserved;
+	char estimators[QDTSHM_MAX_ESTIMATORS][QDTSHM_NAME_SIZE]; // osc address per estimator, ie. "/head"
+	uint64_t head;          // latest frame number, 0 if none yet
+	qdtshm_frame ring[QDTSHM_RING_SIZE]; // frame n is in ring[n % QDTSHM_RING_SIZE]
+} qdtshm_header;
+
+// reader state
+typedef struct {
+	const qdtshm_header *shm; // mapping, NULL if closed
+	uint64_t last;            // last frame read
+} qdtshm_reader;
+
+// open & map the named shared memory object read only, returns 0 on success
+// or -1 if it doesn't exist (yet) or has a different layout
+static inline int qdtshm_open(qdtshm_reader *reader, const char *name) {
+	struct stat st;
+	void *mem;
+	int fd = shm_open(name, O_RDONLY, 0);
+	reader->shm = NULL;
+	reader->last = 0;
+	if(fd < 0) {
+		return -1;
+	}
+	if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(qdtshm_header)) {
+		close(fd);
+		return -1;
+	}
+	mem = mmap(NULL, sizeof(qdtshm_header), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(mem == MAP_FAILED) {
+		return -1;
+	}
+	reader->shm = (const qdtshm_header *)mem;
+	if(memcmp(reader->shm->magic, QDTSHM_MAGIC, 4) != 0 ||
+	   reader->shm->version != QDTSHM_VERSION) {
+		munmap(mem, sizeof(qdtshm_header));
+		reader->shm = NULL;
+		return -1;
+	}
+	return 0;
+}
+
+// unmap
+static inline void qdtshm_close(qdtshm_reader *reader) {
+	if(reader->shm) {
+		munmap((void *)reader->shm, sizeof(qdtshm_header));
+		reader->shm = NULL;
+	}
+}
+
+// copy the latest frame, returns 1 if it is new, 0 if there is no new frame
+// since the last read, or -1 if not open
+static inline int qdtshm_read(qdtshm_reader *reader, qdtshm_frame *frame) {
+	const qdtshm_header *shm = reader->shm;
+	if(!shm) {
+		return -1;
+	}
+	for(;;) {
+		uint64_t head = __atomic_load_n(&shm->head, __ATOMIC_ACQUIRE);
+		const qdtshm_frame *slot;
+		uint64_t sequence;
+		uint32_t numTracks;
+		if(head == 0 || head == reader->last) {
+			return 0;
+		}
+		slot = &shm->ring[head % QDTSHM_RING_SIZE];
+		sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+		if(sequence & 1) {
+			continue; // being written
+		}
+
+		// only copy the used tracks, the count may be torn so clamp it
+		numTracks = slot->numTracks;
+		if(numTracks > QDTSHM_MAX_TRACKS) {
+			numTracks = QDTSHM_MAX_TRACKS;
+		}
+		memcpy(frame, slot, sizeof(qdtshm_frame) - sizeof(frame->tracks) +
+		       numTracks * sizeof(qdtshm_track));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if(__atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) != sequence) {
+			continue; // overwritten while copying
+		}
+		reader->last = frame->frame;
+		return 1;
+	}
+}
+
+#endif
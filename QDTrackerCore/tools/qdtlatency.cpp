@@ -0,0 +1,220 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+// qdtlatency: receive the tracker's /qdtracker/frame messages on this machine
+// & print the capture to send & end to end latencies, & the dropped & lost
+// frame counts: enable bSendLatency in the app settings or use qdtreplay --send
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "FrameLog.h"
+#include "LatencyStats.h"
+
+#define STATS_WINDOW 10000 // max frames summarized, the last ones of longer runs
+
+// received frame latencies
+struct Results {
+	RollingHistogram send;     // capture to send in ms
+	RollingHistogram received; // capture to receive in ms
+	std::uint64_t frames = 0;
+	std::uint64_t lost = 0;    // frames never received, ie. coalesced
+	std::uint64_t lastSequence = 0;
+	std::int64_t firstDropped = -1, dropped = 0; // tracker dropped count
+	bool bVerbose = false;
+	Results(std::size_t frames) : send(frames), received(frames) {}
+};
+
+//--------------------------------------------------------------
+static std::uint32_t read32(const char *data) {
+	const unsigned char *d = (const unsigned char *)data;
+	return ((std::uint32_t)d[0] << 24) | ((std::uint32_t)d[1] << 16) |
+	       ((std::uint32_t)d[2] << 8) | (std::uint32_t)d[3];
+}
+
+//--------------------------------------------------------------
+static std::uint64_t read64(const char *data) {
+	return ((std::uint64_t)read32(data) << 32) | read32(data + 4);
+}
+
+// padded osc string size, 0 if not terminated within size
+//--------------------------------------------------------------
+static std::size_t stringSize(const char *data, std::size_t size) {
+	const char *end = (const char *)std::memchr(data, 0, size);
+	if(!end) {
+		return 0;
+	}
+	return ((end - data) + 4) & ~(std::size_t)3;
+}
+
+// handle a packet, recursing into bundles, received at time now in us
+//--------------------------------------------------------------
+static void handlePacket(const char *data, std::size_t size, std::uint64_t now, Results &results) {
+	if(size >= 16 && std::memcmp(data, "#bundle", 8) == 0) {
+		std::size_t pos = 16;
+		while(pos + 4 <= size) {
+			std::size_t length = read32(data + pos);
+			if(pos + 4 + length > size) {
+				return;
+			}
+			handlePacket(data + pos + 4, length, now, results);
+			pos += 4 + length;
+		}
+		return;
+	}
+	std::size_t addressSize = stringSize(data, size);
+	if(addressSize == 0 || std::strcmp(data, "/qdtracker/frame") != 0) {
+		return;
+	}
+	std::size_t typesSize = stringSize(data + addressSize, size - addressSize);
+	if(typesSize == 0 || std::strcmp(data + addressSize, ",hhfh") != 0 ||
+	   addressSize + typesSize + 28 > size) {
+		return;
+	}
+	const char *args = data + addressSize + typesSize;
+	std::uint64_t sequence = read64(args);
+	std::uint64_t captureTime = read64(args + 8);
+	std::uint32_t bits = read32(args + 16);
+	float sendLatency;
+	std::memcpy(&sendLatency, &bits, 4);
+	std::int64_t dropped = (std::int64_t)read64(args + 20);
+
+	// udp may reorder or duplicate, only count each frame once
+	if(sequence <= results.lastSequence) {
+		return;
+	}
+	if(results.lastSequence > 0) {
+		results.lost += sequence - results.lastSequence - 1;
+	}
+	results.lastSequence = sequence;
+	if(results.firstDropped < 0) {
+		results.firstDropped = dropped;
+	}
+	results.dropped = dropped;
+	float latency = (now - captureTime) / 1000.0f;
+	results.send.add(sendLatency);
+	results.received.add(latency);
+	results.frames++;
+	if(results.bVerbose) {
+		std::printf("frame %llu: send %.3f ms, received %.3f ms, %lld dropped\n",
+		            (unsigned long long)sequence, sendLatency, latency, (long long)dropped);
+	}
+}
+
+//--------------------------------------------------------------
+static void usage() {
+	std::printf("Usage: qdtlatency [options]\n\n");
+	std::printf("  -p, --port N     port to listen on, default 9000\n");
+	std::printf("  -n, --frames N   frames to measure, default 300, latencies are for the\n");
+	std::printf("                   last %d at most\n", STATS_WINDOW);
+	std::printf("  -t, --timeout S  give up after S seconds without frames, default 5\n");
+	std::printf("  -v, --verbose    print each frame\n");
+	std::printf("  -h, --help       this help\n\n");
+	std::printf("Measures the latency of the /qdtracker/frame messages sent by the tracker\n");
+	std::printf("on this machine: capture to send as reported by the tracker & capture to\n");
+	std::printf("receive using the shared monotonic clock\n");
+}
+
+//--------------------------------------------------------------
+int main(int argc, char *argv[]) {
+	int port = 9000, timeout = 5;
+	std::size_t frames = 300;
+	bool bVerbose = false;
+	for(int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool hasValue = (i+1 < argc);
+		if((arg == "-p" || arg == "--port") && hasValue) {
+			port = std::atoi(argv[++i]);
+		}
+		else if((arg == "-n" || arg == "--frames") && hasValue) {
+			frames = std::strtoul(argv[++i], nullptr, 10);
+		}
+		else if((arg == "-t" || arg == "--timeout") && hasValue) {
+			timeout = std::atoi(argv[++i]);
+		}
+		else if(arg == "-v" || arg == "--verbose") {
+			bVerbose = true;
+		}
+		else if(arg == "-h" || arg == "--help") {
+			usage();
+			return 0;
+		}
+		else {
+			usage();
+			return 1;
+		}
+	}
+	if(frames < 1) {
+		frames = 1;
+	}
+
+	int sock = socket(AF_INET, SOCK_DGRAM, 0);
+	sockaddr_in address;
+	std::memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons(port);
+	if(sock < 0 || bind(sock, (const sockaddr *)&address, sizeof(address)) != 0) {
+		std::fprintf(stderr, "couldn't listen on port %d: %s\n", port, std::strerror(errno));
+		return 1;
+	}
+
+	// receive, the receive time is taken as soon as the packet arrives
+	Results results(std::min(frames, (std::size_t)STATS_WINDOW));
+	results.bVerbose = bVerbose;
+	static char data[65536];
+	while(results.frames < frames) {
+		fd_set fds;
+		FD_ZERO(&fds);
+		FD_SET(sock, &fds);
+		timeval wait = {timeout, 0};
+		if(select(sock + 1, &fds, nullptr, nullptr, &wait) <= 0) {
+			std::fprintf(stderr, "timed out after %llu frames\n", (unsigned long long)results.frames);
+			break;
+		}
+		long size = recv(sock, data, sizeof(data), 0);
+		std::uint64_t now = FrameLog::now();
+		if(size > 0) {
+			handlePacket(data, size, now, results);
+		}
+	}
+	close(sock);
+	if(results.frames == 0) {
+		return 1;
+	}
+
+	std::printf("%llu frames, %llu lost, %lld dropped by the tracker\n",
+	            (unsigned long long)results.frames, (unsigned long long)results.lost,
+	            (long long)(results.dropped - results.firstDropped));
+	std::printf("latency          p50    p95    p99    max ms\n");
+	std::printf("%-14s %6.2f %6.2f %6.2f %6.2f\n", "send", results.send.percentile(0.5f),
+	            results.send.percentile(0.95f), results.send.percentile(0.99f), results.send.max());
+	std::printf("%-14s %6.2f %6.2f %6.2f %6.2f\n", "received", results.received.percentile(0.5f),
+	            results.received.percentile(0.95f), results.received.percentile(0.99f), results.received.max());
+	return 0;
+}
@@ -0,0 +1,352 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+// qdtreplay: replay a .qdt depth recording through the tracker core as fast
+// as possible & print the per-stage latencies, for benchmarking without a
+// kinect or openFrameworks
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "DepthStream.h"
+#include "FrameLog.h"
+#include "LatencyStats.h"
+#include "TrackerCore.h"
+#include "HeadEstimator.h"
+#include "OverheadEstimator.h"
+#include "OscPacket.h"
+#include "ShmOutput.h"
+#include "UdpSender.h"
+
+#define MAX_PERSONS 16
+#define WARMUP_FRAMES 30 // frames before counting allocations
+#define STATS_WINDOW 10000 // max frames summarized, the last ones of longer replays
+
+// heap allocations, counted while checking
+static std::atomic<bool> bCountAllocs(false);
+static std::atomic<std::size_t> numAllocs(0);
+
+//--------------------------------------------------------------
+void* operator new(std::size_t size) {
+	if(bCountAllocs) {
+		numAllocs++;
+	}
+	void *p = std::malloc(size > 0 ? size : 1);
+	if(!p) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+//--------------------------------------------------------------
+void operator delete(void *p) noexcept {
+	std::free(p);
+}
+
+//--------------------------------------------------------------
+static void usage() {
+	std::printf("Usage: qdtreplay [options] FILE.qdt\n\n");
+	std::printf("  -e, --estimator NAME  head, overhead, or both, default head\n");
+	std::printf("  -t, --threshold MM    person finder depth threshold in mm, default 1800\n");
+	std::printf("  -m, --max-persons N   max number of persons (1-%d), default 4\n", MAX_PERSONS);
+	std::printf("  --near MM             near clipping in mm, default 500\n");
+	std::printf("  --far MM              far clipping in mm, default 4000\n");
+	std::printf("  --min-area N          person min area, default by estimator\n");
+	std::printf("  --max-area N          person max area, default by estimator\n");
+	std::printf("  --predict             only search around predicted persons\n");
+	std::printf("  -j, --threads N       split each frame across N threads, default 1\n");
+	std::printf("  --pyramid LEVEL       label at 1/2^LEVEL size (0-%d), default 0\n", MAX_PYRAMID_LEVEL);
+	std::printf("  -b, --background      subtract the background learned from the recording\n");
+	std::printf("  --margin MM           background margin in mm, default 100\n");
+	std::printf("  -d, --denoise         fill holes, 3x3 median, & smooth the depth over time\n");
+	std::printf("  --median SIZE         denoise median size, 0, 3, or 5, default 3\n");
+	std::printf("  -i, --incremental     only threshold changed tiles & skip static frames\n");
+	std::printf("  --tolerance MM        incremental per pixel noise tolerance in mm, default 30\n");
+	std::printf("  -w, --world           output camera coordinates in mm from the recording's intrinsics\n");
+	std::printf("  -l, --loops N         replay the recording N times, default 1, latencies\n");
+	std::printf("                        are for the last %d frames at most\n", STATS_WINDOW);
+	std::printf("  --shm NAME            write each frame's tracks to the shared memory ring NAME\n");
+	std::printf("  --send HOSTS          send each frame's osc bundle with its latency to HOSTS,\n");
+	std::printf("                        host or host:port list, default port 9000, ie. for qdtlatency\n");
+	std::printf("  --check-allocs        fail if any frame allocates after %d warm-up frames,\n", WARMUP_FRAMES);
+	std::printf("                        including encoding the osc output\n");
+}
+
+//--------------------------------------------------------------
+int main(int argc, char *argv[]) {
+	std::string file, name = "head", shmName, sendHosts;
+	TrackerCore::Settings settings;
+	float nearClipping = 500, farClipping = 4000;
+	int minArea = -1, maxArea = -1, loops = 1, medianSize = 3;
+	bool bCheckAllocs = false;
+	for(int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool hasValue = (i+1 < argc);
+		if((arg == "-e" || arg == "--estimator") && hasValue) {
+			name = argv[++i];
+		}
+		else if((arg == "-t" || arg == "--threshold") && hasValue) {
+			settings.threshold = std::atoi(argv[++i]);
+		}
+		else if((arg == "-m" || arg == "--max-persons") && hasValue) {
+			settings.maxPersons = std::atoi(argv[++i]);
+		}
+		else if(arg == "--near" && hasValue) {
+			nearClipping = std::atof(argv[++i]);
+		}
+		else if(arg == "--far" && hasValue) {
+			farClipping = std::atof(argv[++i]);
+		}
+		else if(arg == "--min-area" && hasValue) {
+			minArea = std::atoi(argv[++i]);
+		}
+		else if(arg == "--max-area" && hasValue) {
+			maxArea = std::atoi(argv[++i]);
+		}
+		else if(arg == "--predict") {
+			settings.bPredictRegion = true;
+		}
+		else if((arg == "-j" || arg == "--threads") && hasValue) {
+			settings.threads = std::atoi(argv[++i]);
+		}
+		else if(arg == "--pyramid" && hasValue) {
+			settings.pyramidLevel = std::atoi(argv[++i]);
+		}
+		else if(arg == "-b" || arg == "--background") {
+			settings.bBackground = true;
+		}
+		else if(arg == "--margin" && hasValue) {
+			settings.backgroundMargin = std::atoi(argv[++i]);
+		}
+		else if(arg == "-d" || arg == "--denoise") {
+			settings.denoise.bFillHoles = true;
+			settings.denoise.smoothing = 0.5;
+		}
+		else if(arg == "--median" && hasValue) {
+			medianSize = std::atoi(argv[++i]);
+		}
+		else if(arg == "-i" || arg == "--incremental") {
+			settings.bIncremental = true;
+		}
+		else if(arg == "--tolerance" && hasValue) {
+			settings.changeTolerance = std::atoi(argv[++i]);
+		}
+		else if(arg == "-w" || arg == "--world") {
+			settings.transform.bWorld = true;
+		}
+		else if((arg == "-l" || arg == "--loops") && hasValue) {
+			loops = std::atoi(argv[++i]);
+		}
+		else if(arg == "--shm" && hasValue) {
+			shmName = argv[++i];
+		}
+		else if(arg == "--send" && hasValue) {
+			sendHosts = argv[++i];
+		}
+		else if(arg == "--check-allocs") {
+			bCheckAllocs = true;
+		}
+		else if(arg == "-h" || arg == "--help") {
+			usage();
+			return 0;
+		}
+		else if(arg[0] != '-' && file == "") {
+			file = arg;
+		}
+		else {
+			usage();
+			return 1;
+		}
+	}
+	if(file == "") {
+		usage();
+		return 1;
+	}
+	if(settings.maxPersons < 1 || settings.maxPersons > MAX_PERSONS) {
+		std::fprintf(stderr, "max persons must be 1-%d\n", MAX_PERSONS);
+		return 1;
+	}
+	if(loops < 1) {
+		loops = 1;
+	}
+
+	// estimators & their person finder defaults, same as the apps
+	HeadEstimator head;
+	OverheadEstimator overhead;
+	std::vector<const Estimator*> estimators;
+	if(name == "head") {
+		estimators.push_back(&head);
+	}
+	else if(name == "overhead") {
+		estimators.push_back(&overhead);
+		settings.personMinArea = 5;
+		settings.personMaxArea = 3000;
+	}
+	else if(name == "both") {
+		estimators.push_back(&head);
+		estimators.push_back(&overhead);
+	}
+	else {
+		std::fprintf(stderr, "unknown estimator: %s\n", name.c_str());
+		return 1;
+	}
+	if(minArea >= 0) settings.personMinArea = minArea;
+	if(maxArea >= 0) settings.personMaxArea = maxArea;
+	if(settings.denoise.bFillHoles) settings.denoise.medianSize = medianSize;
+
+	DepthPlayer player;
+	if(!player.open(file)) {
+		std::fprintf(stderr, "couldn't open %s: %s\n", file.c_str(), player.getError().c_str());
+		return 1;
+	}
+	std::size_t width = player.getWidth(), height = player.getHeight();
+	settings.transform.width = width;
+	settings.transform.height = height;
+	settings.transform.depthNear = nearClipping;
+	settings.transform.depthFar = farClipping;
+
+	TrackerCore core;
+	core.setup(width, height, MAX_PERSONS);
+	core.getRays().setup(width, height, player.getZeroPlanePixelSize(), player.getZeroPlaneDistance());
+	core.setEstimators(estimators.data(), estimators.size());
+	core.setSettings(settings);
+
+	// outputs, addressed the same as the apps
+	std::vector<std::string> addresses;
+	for(const Estimator *estimator : estimators) {
+		addresses.push_back(std::string("/") + estimator->getName());
+	}
+	ShmOutput shm;
+	if(shmName != "" && !shm.setup(shmName, addresses.data(), addresses.size())) {
+		std::fprintf(stderr, "%s\n", shm.getError().c_str());
+		return 1;
+	}
+	UdpSender sender;
+	if(sendHosts != "" && !sender.setup(sendHosts, 9000)) {
+		std::fprintf(stderr, "%s\n", sender.getError().c_str());
+		return 1;
+	}
+
+	DepthFrame frame;
+	frame.rawStride = width;
+	frame.width = width;
+	frame.height = height;
+
+	// replay, the raw depth is used straight from the mapped recording
+	LatencyStats stats;
+	OscPacket packet;
+	std::size_t frames = player.getFrameCount() * loops, persons = 0, count = 0;
+	std::size_t changedTiles = 0, skipped = 0;
+	stats.setup(TrackerCore::stageNames(estimators.data(), estimators.size()),
+	            std::min(frames, (std::size_t)STATS_WINDOW));
+	for(int loop = 0; loop < loops; ++loop) {
+		for(std::size_t i = 0; i < player.getFrameCount(); ++i) {
+			if(bCheckAllocs && count++ == WARMUP_FRAMES) {
+				bCountAllocs = true;
+			}
+			std::uint64_t captureTime = FrameLog::now();
+			std::uint64_t frameClock = std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::system_clock::now().time_since_epoch()).count(); // for receivers
+			stats.startFrame();
+			frame.raw = player.getDepth(i);
+			stats.lap(TrackerCore::STAGE_GRAB);
+			persons += core.process(frame, &stats);
+			changedTiles += core.getNumChangedTiles();
+			skipped += (core.getNumChangedTiles() == 0);
+			core.track();
+			stats.lap(TrackerCore::STAGE_TRACK);
+			stats.endFrame();
+			if(bCheckAllocs || sender.isOpen()) {
+				// as sent by the apps, one bundle per frame
+				packet.beginBundle(OscPacket::timetag(frameClock));
+				packet.begin("/qdtracker/frame", "hhfh");
+				packet.addInt64(loop * player.getFrameCount() + i + 1);
+				packet.addInt64(captureTime);
+				packet.addFloat((FrameLog::now() - captureTime) / 1000.0f);
+				packet.addInt64(0);
+				for(std::size_t p = 0; p < core.size(); ++p) {
+					for(std::size_t e = 0; e < estimators.size(); ++e) {
+						const Position &position = core[p].positions[e];
+						packet.begin(addresses[e].c_str(), "ifff");
+						packet.addInt(core[p].id);
+						packet.addFloat(position.x);
+						packet.addFloat(position.y);
+						packet.addFloat(position.z);
+					}
+				}
+				packet.endBundle();
+				sender.send(packet.getData(), packet.getSize());
+			}
+			if(shm.isOpen()) {
+				qdtshm_frame &tracks = shm.begin();
+				tracks.numTracks = 0;
+				for(std::size_t p = 0; p < core.size() && p < QDTSHM_MAX_TRACKS; ++p) {
+					qdtshm_track &track = tracks.tracks[tracks.numTracks++];
+					track.id = core[p].id;
+					for(std::size_t e = 0; e < estimators.size() && e < QDTSHM_MAX_ESTIMATORS; ++e) {
+						const Position &position = core[p].positions[e];
+						track.positions[e][0] = position.x;
+						track.positions[e][1] = position.y;
+						track.positions[e][2] = position.z;
+					}
+				}
+				shm.publish(frameClock);
+			}
+		}
+	}
+	bCountAllocs = false;
+
+	// filter & send are the app's, so skip them
+	std::vector<LatencyStats::Summary> summaries;
+	stats.summarize(summaries);
+	std::printf("%s: %zu frames %zux%zu, %.2f persons per frame\n", file.c_str(),
+	            frames, width, height, frames ? (float)persons / frames : 0.0f);
+	std::printf("stage            p50    p95    p99    max ms\n");
+	for(std::size_t i = 0; i < summaries.size(); ++i) {
+		if(i == TrackerCore::STAGE_FILTER || i == TrackerCore::STAGE_SEND) {
+			continue;
+		}
+		const LatencyStats::Summary &s = summaries[i];
+		std::printf("%-14s %6.2f %6.2f %6.2f %6.2f\n",
+		            stats.getName(i).c_str(), s.p50, s.p95, s.p99, s.max);
+	}
+	if(settings.bIncremental && frames > 0) {
+		std::printf("%.1f%% tiles changed, %zu static frames skipped\n",
+		            100.0f * changedTiles / (frames * core.getNumTiles()), skipped);
+	}
+	if(bCheckAllocs) {
+		if(count <= WARMUP_FRAMES) {
+			std::fprintf(stderr, "couldn't check allocations: fewer than %d frames\n", WARMUP_FRAMES);
+			return 1;
+		}
+		std::printf("%zu allocations after %d warm-up frames\n", (std::size_t)numAllocs, WARMUP_FRAMES);
+		if(numAllocs > 0) {
+			return 1;
+		}
+	}
+	return 0;
+}
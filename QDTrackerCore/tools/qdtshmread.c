@@ -0,0 +1,102 @@
+/*
+ * QDTrackerCore, part of the Quick N Dirty Tracking system
+ *
+ * Copyright (c) 2014 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See https://github.com/danomatika/QDTracker for documentation
+ *
+ */
+// qdtshmread: print the tracks polled from the tracker's shared memory output
+// ring, an example plain C client using only qdtshm.h
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "qdtshm.h"
+
+//--------------------------------------------------------------
+static void usage(void) {
+	printf("Usage: qdtshmread [options] [NAME]\n\n");
+	printf("  -n, --frames N  quit after N frames, default 0 to run until stopped\n");
+	printf("  -q, --quiet     only print the frame & missed frame counts when done\n");
+	printf("  -h, --help      this help\n\n");
+	printf("NAME is the shared memory object name, default /qdtracker\n");
+}
+
+//--------------------------------------------------------------
+int main(int argc, char *argv[]) {
+	const char *name = "/qdtracker";
+	unsigned long maxFrames = 0, frames = 0, missed = 0;
+	int quiet = 0, i;
+	for(i = 1; i < argc; ++i) {
+		if((!strcmp(argv[i], "-n") || !strcmp(argv[i], "--frames")) && i+1 < argc) {
+			maxFrames = strtoul(argv[++i], NULL, 10);
+		}
+		else if(!strcmp(argv[i], "-q") || !strcmp(argv[i], "--quiet")) {
+			quiet = 1;
+		}
+		else if(!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+			usage();
+			return 0;
+		}
+		else if(argv[i][0] != '-') {
+			name = argv[i];
+		}
+		else {
+			usage();
+			return 1;
+		}
+	}
+
+	qdtshm_reader reader;
+	if(qdtshm_open(&reader, name) != 0) {
+		fprintf(stderr, "couldn't open %s, is the tracker writing it?\n", name);
+		return 1;
+	}
+
+	// poll, skipped frames were overwritten before being read
+	qdtshm_frame frame;
+	uint64_t last = 0;
+	struct timespec wait = {0, 1000000}; // 1 ms
+	while(maxFrames == 0 || frames < maxFrames) {
+		if(qdtshm_read(&reader, &frame) != 1) {
+			nanosleep(&wait, NULL);
+			continue;
+		}
+		if(last != 0 && frame.frame > last + 1) {
+			missed += frame.frame - last - 1;
+		}
+		last = frame.frame;
+		frames++;
+		if(quiet) {
+			continue;
+		}
+		printf("frame %llu %llu us: %u tracks\n", (unsigned long long)frame.frame,
+		       (unsigned long long)frame.timestamp, frame.numTracks);
+		for(uint32_t t = 0; t < frame.numTracks; ++t) {
+			const qdtshm_track *track = &frame.tracks[t];
+			for(uint32_t e = 0; e < reader.shm->numEstimators; ++e) {
+				printf("  %s %u %g %g %g\n", reader.shm->estimators[e], track->id,
+				       track->positions[e][0], track->positions[e][1], track->positions[e][2]);
+			}
+		}
+	}
+	printf("%lu frames, %lu missed\n", frames, missed);
+	qdtshm_close(&reader);
+	return 0;
+}